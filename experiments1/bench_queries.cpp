@@ -0,0 +1,166 @@
+/** Micro-benchmarks of the query kernels, on Google Benchmark.
+ * Usage: ./bench_queries [benchmark flags] <TEXT> [<CPU>]
+ *
+ * For every engine in engines.cpp and pattern length in {4, 8, ..., 64}:
+ *  - count/<engine>/<m>: count() over a batch of patterns,
+ *  - locate/<engine>/<m>: every occurrence of each pattern, for m >= 16
+ *    only: short patterns occur up to hundreds of thousands of times, and
+ *    each FM-index occurrence costs up to a sample rate of LF steps,
+ *  - extract/<engine>/<m>: m characters at random positions,
+ * where engines without the operation are skipped.
+ *
+ * Methodology:
+ *  - each iteration runs a whole batch of queries and results are per
+ *    query (s/query), so clock reads are amortized over the batch,
+ *  - results go through benchmark::DoNotOptimize, so calls are not elided,
+ *  - patterns are drawn from the text up front, outside the timed loop,
+ *  - the process is pinned to one CPU (default 0) to avoid migrations,
+ *    once the indexes are built, so construction still gets every core.
+ * Run with --benchmark_repetitions=N to get the spread across runs. */
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sched.h>
+
+#include <benchmark/benchmark.h>
+
+#include "engines.cpp"
+#include "../src/text_loader.cpp"
+
+const std::int64_t batch_size = 1024;
+const std::vector<std::int64_t> pattern_lengths = {4, 8, 16, 32, 64};
+const std::int64_t locate_min_length = 16;
+
+// Batch of patterns of length m taken from random positions of text
+std::vector<std::string> random_patterns(const std::string& text, std::int64_t m, std::mt19937_64& rng)
+{
+    if (static_cast<std::int64_t>(text.size()) < m + 1)
+        throw std::invalid_argument("random_patterns: text shorter than m + 1");
+    std::uniform_int_distribution<std::int64_t> start(0, text.size() - m - 1);
+    std::vector<std::string> patterns(batch_size);
+    for (auto& p : patterns)
+        p = text.substr(start(rng), m);
+    return patterns;
+}
+
+inline void report_per_query(benchmark::State& state)
+{
+    state.SetItemsProcessed(state.iterations() * batch_size);
+    // Seconds per query, printed with SI prefixes (e.g. 750n)
+    state.counters["s/query"] = benchmark::Counter(batch_size,
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+template <class Index>
+void register_engine(const std::string& name, std::shared_ptr<Index> index, const std::string& text)
+{
+    static_assert(TextIndex<Index>, "engines must model TextIndex");
+    std::mt19937_64 rng(42);
+
+    for (std::int64_t m : pattern_lengths) {
+        auto patterns = std::make_shared<std::vector<std::string>>(random_patterns(text, m, rng));
+        std::string suffix = "/" + name + "/" + std::to_string(m);
+
+        benchmark::RegisterBenchmark(("count" + suffix).c_str(), [index, patterns](benchmark::State& state) {
+            for (auto _ : state) {
+                for (const auto& p : *patterns) {
+                    std::int64_t c = index->count(p);
+                    benchmark::DoNotOptimize(c);
+                }
+            }
+            report_per_query(state);
+        });
+
+        // Shorter patterns would take minutes per iteration, see the header
+        if (m >= locate_min_length) {
+            if constexpr (requires(const Index& i, std::string_view p) { i.locate(p); }) {
+                benchmark::RegisterBenchmark(("locate" + suffix).c_str(), [index, patterns](benchmark::State& state) {
+                    for (auto _ : state) {
+                        for (const auto& p : *patterns) {
+                            auto occurrences = index->locate(p);
+                            benchmark::DoNotOptimize(occurrences);
+                        }
+                    }
+                    report_per_query(state);
+                });
+            } else if constexpr (requires(const Index& i, std::string_view p) { i.interval(p); i[std::int64_t(0)]; }) {
+                // Native SAs: the interval, then each SA entry in it
+                benchmark::RegisterBenchmark(("locate" + suffix).c_str(), [index, patterns](benchmark::State& state) {
+                    for (auto _ : state) {
+                        for (const auto& p : *patterns) {
+                            auto [first, last] = index->interval(p);
+                            for (std::int64_t i = first; i < last; i++) {
+                                std::int64_t position = (*index)[i];
+                                benchmark::DoNotOptimize(position);
+                            }
+                        }
+                    }
+                    report_per_query(state);
+                });
+            }
+        }
+
+        if constexpr (requires(const Index& i) { i.extract(std::size_t(0), std::size_t(0)); }) {
+            auto starts = std::make_shared<std::vector<std::size_t>>(batch_size);
+            std::uniform_int_distribution<std::size_t> start(0, text.size() - m - 1);
+            for (auto& s : *starts)
+                s = start(rng);
+            benchmark::RegisterBenchmark(("extract" + suffix).c_str(), [index, starts, m](benchmark::State& state) {
+                for (auto _ : state) {
+                    for (std::size_t s : *starts) {
+                        std::string substring = index->extract(s, s + m - 1);
+                        benchmark::DoNotOptimize(substring);
+                    }
+                }
+                report_per_query(state);
+            });
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // Leaves only our own arguments in argv
+    benchmark::Initialize(&argc, argv);
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: [benchmark flags] <TEXT> [<CPU>]" << std::endl;
+        std::cerr << "<TEXT>: file to index." << std::endl;
+        std::cerr << "<CPU>: CPU to pin the benchmark to, 0 by default." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string text = load_sequences({argv[1]}).text;
+    // Patterns and extracted substrings start anywhere in [0, n - m)
+    if (static_cast<std::int64_t>(text.size()) < pattern_lengths.back() + 1) {
+        std::cerr << "<TEXT> must be longer than " << pattern_lengths.back() << " characters." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Indexes stay alive until the benchmarks have run, so each one gets
+    // its own copy of the text
+    construction_arena arena;
+    for_each_engine([&](const std::string& name, auto build) {
+        std::shared_ptr index = build(text, arena);
+        register_engine(name, index, text);
+    });
+
+    // Pinned only now: parallel construction would be confined to one CPU
+    int cpu = argc == 3 ? std::stoi(argv[2]) : 0;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0)
+        std::cerr << "Could not pin to CPU " << cpu << ", running unpinned" << std::endl;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
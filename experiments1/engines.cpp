@@ -0,0 +1,70 @@
+/** Engine registry shared by the benchmark harnesses.
+ *
+ * for_each_engine(f) calls f(name, build) once per engine, where
+ * build(text, arena) returns the index in a unique_ptr. Each call has the
+ * concrete index type, so harness templates are instantiated per engine
+ * and query through direct calls. Add a line here to benchmark a new
+ * engine in every harness.
+ *
+ * text is taken by value and moved into the native indexes, so a harness
+ * passing an rvalue holds a single copy of the text while building. */
+
+#ifndef ENGINES
+#define ENGINES
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "../src/text_index.cpp"
+#include "../src/suffix_array.cpp"
+#include "../src/suffix_array_lcp.cpp"
+#include "../src/sparse_suffix_array.cpp"
+#include "../src/byte_fmindex.cpp"
+#include "../src/dynamic_suffix_array.cpp"
+
+// The sdsl engines are registered only when sdsl is available
+#if __has_include(<sdsl/suffix_arrays.hpp>)
+#include "../src/suffix_array_sdsl.cpp"
+#include "../src/fmindex.cpp"
+#define ENGINES_HAVE_SDSL 1
+#else
+#define ENGINES_HAVE_SDSL 0
+#endif
+
+template <class F>
+void for_each_engine(F&& f)
+{
+    f("sa", [](std::string text, construction_arena& arena) {
+        return std::make_unique<suffix_array>(std::move(text), sa_construction::packed_doubling, default_threads(),
+                                              memory_policy{}, &arena);
+    });
+    f("salcp", [](std::string text, construction_arena& arena) {
+        return std::make_unique<suffix_array_lcp<>>(std::move(text), sa_construction::packed_doubling,
+                                                    default_threads(), memory_policy{}, &arena);
+    });
+    f("sparse", [](std::string text, construction_arena& arena) {
+        return std::make_unique<sparse_suffix_array>(std::move(text), 4, sa_construction::packed_doubling,
+                                                     memory_policy{}, &arena);
+    });
+    f("fmbyte", [](std::string text, construction_arena& arena) {
+        return std::make_unique<byte_fmindex<>>(std::move(text), sa_construction::packed_doubling, default_threads(),
+                                                &arena);
+    });
+    f("fmblock", [](std::string text, construction_arena& arena) {
+        return std::make_unique<byte_fmindex<>>(std::move(text), blockwise_bwt{}, &arena);
+    });
+    f("dynsa", [](std::string text, construction_arena&) {
+        return std::make_unique<dynamic_suffix_array>(std::move(text));
+    });
+#if ENGINES_HAVE_SDSL
+    f("sasdsl", [](std::string text, construction_arena&) {
+        return std::make_unique<sdsl_suffix_array<>>(text);
+    });
+    f("fmindex", [](std::string text, construction_arena&) {
+        return std::make_unique<fmindex<>>(text);
+    });
+#endif
+}
+
+#endif
@@ -0,0 +1,173 @@
+/** uhr: generic time performance tester
+ * Author: LELE
+ *
+ * Runs the count experiment on any engine of the registry in engines.cpp.
+ * Engines are TextIndex types (see src/text_index.cpp) and run_engine is
+ * instantiated once per engine, so count() is a direct call.
+ *
+ * Things to set up:
+ * 0. Includes: include all files to be tested,
+ * 1. Time unit: in elapsed_time,
+ * 2. What to write on time_data,
+ * 3. Data type and distribution of RNG,
+ * 4. Additive or multiplicative stepping,
+ * 5. The experiments: in run_engine,
+ * 6. The engines: in engines.cpp. */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <sstream>
+
+// Include to be tested files here
+#include "../src/memory_tracker.cpp"
+#include "engines.cpp"
+#include "../src/text_loader.cpp"
+#include "../src/uhr_harness.cpp"
+
+template <class Build>
+void run_engine(const std::string& engine, Build& build, const std::string& filename, std::int64_t runs,
+    std::int64_t lower, std::int64_t upper, std::int64_t step)
+{
+    using Index = typename std::invoke_result_t<Build&, std::string, construction_arena&>::element_type;
+    static_assert(TextIndex<Index>, "engines must model TextIndex");
+
+    // Set up clock variables
+    std::int64_t n, i, executed_runs;
+    std::int64_t total_runs_additive = runs * (((upper - lower) / step) + 1);
+    std::vector<double> times(runs);
+    std::vector<double> q;
+    double mean_time, time_stdev, dev;
+    auto begin_time = std::chrono::high_resolution_clock::now();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::nano> elapsed_time = end_time - begin_time;
+
+    // Set up random number generation
+    std::random_device rd;
+    std::mt19937_64 rng(rd());
+    std::uniform_int_distribution<std::int64_t> u_distr; // change depending on app
+
+    // File to write time data
+    std::ofstream time_data;
+    time_data.open(filename);
+    time_data << "n,t_mean,t_stdev,t_Q0,t_Q1,t_Q2,t_Q3,t_Q4,allocations" << std::endl;
+
+    std::ofstream construct_data;
+    construct_data.open("construct_data_" + engine + ".csv");
+    construct_data << "n,time,space,peak_heap,allocations,peak_rss" << std::endl;
+
+    // Begin testing
+    std::cout << "\033[0;36mRunning tests on " << engine << "...\033[0m" << std::endl << std::endl;
+    executed_runs = 0;
+
+    // Scratch memory reused by every build
+    construction_arena arena;
+    for (n = lower; n <= upper; n += step) {
+        mean_time = 0;
+        time_stdev = 0;
+
+        // Vector of text files
+        std::string path = "/home/dataset/";
+        std::vector<std::string> text_files = {"sources", "dna", "proteins", "GCF_000001405.40_GRCh38.p14_genomic.fna"};
+
+        // Load text
+        std::string text = load_sequences({path+text_files[n-1]}).text;
+
+        // Generate random pattern
+        std::int64_t pattern_length = 15;
+        std::string pattern = get_random_pattern(text, rng, u_distr, pattern_length);
+        std::cout << "Pattern: " << pattern << std::endl;
+
+        // Construct index; the text is moved in, so it is held only once
+        memory_phase construct_phase;
+        begin_time = std::chrono::high_resolution_clock::now();
+        std::unique_ptr<Index> index = build(std::move(text), arena);
+        end_time = std::chrono::high_resolution_clock::now();
+        phase_memory construct_memory = construct_phase.finish();
+        elapsed_time = end_time - begin_time;
+
+        // Write construction data
+        construct_data << text_files[n-1] << "," << elapsed_time.count() << "," << index->size_in_bytes() << ","
+                       << construct_memory.peak_heap << "," << construct_memory.allocations << "," << construct_memory.peak_rss << std::endl;
+
+        // Run to compute elapsed time
+        memory_phase query_phase;
+        for (i = 0; i < runs; i++) {
+            // Remember to change total depending on step type
+            display_progress(++executed_runs, total_runs_additive);
+
+            begin_time = std::chrono::high_resolution_clock::now();
+            index->count(pattern);
+            end_time = std::chrono::high_resolution_clock::now();
+
+            elapsed_time = end_time - begin_time;
+            times[i] = elapsed_time.count();
+
+            mean_time += times[i];
+        }
+
+        phase_memory query_memory = query_phase.finish();
+
+        // Compute statistics
+        mean_time /= runs;
+
+        for (i = 0; i < runs; i++) {
+            dev = times[i] - mean_time;
+            time_stdev += dev * dev;
+        }
+
+        time_stdev /= runs - 1; // Subtract 1 to get unbiased estimator
+        time_stdev = std::sqrt(time_stdev);
+
+        quartiles(times, q);
+
+        time_data << text_files[n-1] << "," << mean_time << "," << time_stdev << ",";
+        time_data << q[0] << "," << q[1] << "," << q[2] << "," << q[3] << "," << q[4] << "," << query_memory.allocations << std::endl;
+    }
+
+    // This is to keep loading bar after testing
+    std::cout << std::endl << std::endl;
+
+    time_data.close();
+}
+
+int main(int argc, char *argv[])
+{
+    // Validate and sanitize input
+    std::string engine;
+    std::int64_t runs, lower, upper, step;
+    validate_input(argc, argv, runs, lower, upper, step,
+        {{"<ENGINE>"}, {}, {"<ENGINE>: sa, salcp, sparse, fmbyte, fmblock, dynsa, sasdsl, fmindex or all."}});
+    engine = argv[2];
+
+    // With "all", every engine writes <engine>_<filename>
+    bool found = false;
+    for_each_engine([&](const std::string& name, auto build) {
+        if (engine != "all" && engine != name)
+            return;
+        found = true;
+        std::string filename = engine == "all" ? name + "_" + argv[1] : argv[1];
+        run_engine(name, build, filename, runs, lower, upper, step);
+    });
+
+    if (!found) {
+        std::cerr << "Unknown engine: " << engine << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "\033[1;32mDone!\033[0m" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+/** uhr: generic time performance tester
+ * Author: LELE
+ *
+ * Things to set up:
+ * 0. Includes: include all files to be tested,
+ * 1. Time unit: in elapsed_time,
+ * 2. What to write on time_data,
+ * 3. Data type and distribution of RNG,
+ * 4. Additive or multiplicative stepping,
+ * 5. The experiments: in outer for loop. */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sstream>
+
+// Include to be tested files here
+#include "../src/suffix_array.cpp"
+#include "../src/text_loader.cpp"
+#include "../src/uhr_harness.cpp"
+
+int main(int argc, char *argv[])
+{
+    // Validate and sanitize input
+    // Here <RUNS> is the number of timed passes over the pattern batch
+    std::int64_t runs, lower, upper, step;
+    validate_input(argc, argv, runs, lower, upper, step);
+
+    // Searches in flight per batch; 0 stands for one count() call at a time
+    std::vector<std::int64_t> groups = {0, 1, 2, 4, 8, 16, 32, 64};
+    const std::int64_t batch_size = 1 << 16;
+
+    std::int64_t n, i, executed_runs;
+    std::int64_t total_runs_additive = groups.size() * runs * (((upper - lower) / step) + 1);
+    std::vector<double> times(runs);
+    std::vector<double> q;
+    double mean_time, time_stdev, dev;
+    auto begin_time = std::chrono::high_resolution_clock::now();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::nano> elapsed_time = end_time - begin_time;
+
+    // Set up random number generation
+    std::random_device rd;
+    std::mt19937_64 rng(rd());
+    std::uniform_int_distribution<std::int64_t> u_distr; // change depending on app
+
+    // File to write time data, times are per query
+    std::ofstream time_data;
+    time_data.open(argv[1]);
+    time_data << "n,group,t_mean,t_stdev,t_Q0,t_Q1,t_Q2,t_Q3,t_Q4,identical" << std::endl;
+
+    // Begin testing
+    std::cout << "\033[0;36mRunning tests...\033[0m" << std::endl << std::endl;
+    executed_runs = 0;
+    for (n = lower; n <= upper; n += step) {
+        // Vector of text files
+        std::string path = "/home/dataset/";
+        std::vector<std::string> text_files = {"sources", "dna", "proteins", "GCF_000001405.40_GRCh38.p14_genomic.fna"};
+
+        // Load text
+        std::string text = load_sequences({path+text_files[n-1]}).text;
+        suffix_array sa(text);
+
+        std::int64_t pattern_length = 15;
+        std::vector<std::string> patterns(batch_size);
+        for (i = 0; i < batch_size; i++)
+            patterns[i] = get_random_pattern(text, rng, u_distr, pattern_length);
+
+        std::vector<std::int64_t> reference;
+        for (std::int64_t group : groups) {
+            mean_time = 0;
+            time_stdev = 0;
+            std::vector<std::int64_t> counts;
+
+            for (i = 0; i < runs; i++) {
+                display_progress(++executed_runs, total_runs_additive);
+
+                begin_time = std::chrono::high_resolution_clock::now();
+                if (group == 0) {
+                    counts.clear();
+                    for (const auto& pattern : patterns)
+                        counts.push_back(sa.count(pattern));
+                } else {
+                    counts = sa.count_batch(patterns, group);
+                }
+                end_time = std::chrono::high_resolution_clock::now();
+
+                elapsed_time = end_time - begin_time;
+                times[i] = elapsed_time.count() / batch_size;
+                mean_time += times[i];
+            }
+
+            if (reference.empty())
+                reference = counts;
+
+            // Compute statistics
+            mean_time /= runs;
+
+            for (i = 0; i < runs; i++) {
+                dev = times[i] - mean_time;
+                time_stdev += dev * dev;
+            }
+
+            time_stdev /= runs - 1; // Subtract 1 to get unbiased estimator
+            time_stdev = std::sqrt(time_stdev);
+
+            quartiles(times, q);
+
+            time_data << text_files[n-1] << "," << group << "," << mean_time << "," << time_stdev << ",";
+            time_data << q[0] << "," << q[1] << "," << q[2] << "," << q[3] << "," << q[4] << ",";
+            time_data << (counts == reference) << std::endl;
+        }
+    }
+
+    // This is to keep loading bar after testing
+    std::cout << std::endl << std::endl;
+    std::cout << "\033[1;32mDone!\033[0m" << std::endl;
+
+    time_data.close();
+
+    return 0;
+}
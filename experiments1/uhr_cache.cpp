@@ -0,0 +1,166 @@
+/** uhr: generic time performance tester
+ * Author: LELE
+ *
+ * Things to set up:
+ * 0. Includes: include all files to be tested,
+ * 1. Time unit: in elapsed_time,
+ * 2. What to write on time_data,
+ * 3. Data type and distribution of RNG,
+ * 4. Additive or multiplicative stepping,
+ * 5. The experiments: in outer for loop. */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sstream>
+
+// Include to be tested files here
+#include "../src/suffix_array.cpp"
+#include "../src/query_cache.cpp"
+#include "../src/text_loader.cpp"
+#include "../src/uhr_harness.cpp"
+
+// Zipf(s) over ranks 0..m-1 via inverse CDF
+std::vector<double> zipf_cdf(std::int64_t m, double s) {
+    std::vector<double> cdf(m);
+    double total = 0;
+    for (std::int64_t i = 0; i < m; i++) {
+        total += 1.0 / std::pow(i + 1, s);
+        cdf[i] = total;
+    }
+    for (auto& c : cdf)
+        c /= total;
+    return cdf;
+}
+
+// Time every query of the stream and write one row
+template <class Counter>
+void time_stream(const std::string& dataset, const std::string& mode, Counter&& count_pattern,
+    const std::vector<std::string>& stream, std::ofstream& time_data,
+    std::int64_t& executed_runs, std::int64_t total_runs, double& hit_rate, std::int64_t& prefix_hits)
+{
+    std::int64_t runs = stream.size();
+    std::int64_t i, matches = 0;
+    std::vector<double> times(runs);
+    std::vector<double> q;
+    double mean_time = 0, time_stdev = 0, dev;
+    auto begin_time = std::chrono::high_resolution_clock::now();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::nano> elapsed_time;
+
+    for (i = 0; i < runs; i++) {
+        if (++executed_runs % 1024 == 0)
+            display_progress(executed_runs, total_runs);
+
+        begin_time = std::chrono::high_resolution_clock::now();
+        matches += count_pattern(stream[i]);
+        end_time = std::chrono::high_resolution_clock::now();
+
+        elapsed_time = end_time - begin_time;
+        times[i] = elapsed_time.count();
+        mean_time += times[i];
+    }
+
+    mean_time /= runs;
+    for (i = 0; i < runs; i++) {
+        dev = times[i] - mean_time;
+        time_stdev += dev * dev;
+    }
+    time_stdev /= runs - 1; // Subtract 1 to get unbiased estimator
+    time_stdev = std::sqrt(time_stdev);
+
+    quartiles(times, q);
+
+    time_data << dataset << "," << mode << "," << hit_rate << "," << prefix_hits << "," << matches << ",";
+    time_data << mean_time << "," << time_stdev << ",";
+    time_data << q[0] << "," << q[1] << "," << q[2] << "," << q[3] << "," << q[4] << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    // Validate and sanitize input
+    // Here <RUNS> is the number of queries in the skewed stream
+    std::int64_t runs, lower, upper, step;
+    validate_input(argc, argv, runs, lower, upper, step);
+
+    std::int64_t n, i, executed_runs;
+    std::int64_t total_runs_additive = 2 * runs * (((upper - lower) / step) + 1);
+
+    // Stream shape: distinct patterns, Zipf exponent and cache capacity
+    const std::int64_t pool_size = 1 << 16;
+    const double zipf_s = 1.0;
+    const std::size_t cache_capacity = 1 << 12;
+
+    // Set up random number generation
+    std::random_device rd;
+    std::mt19937_64 rng(rd());
+    std::uniform_int_distribution<std::int64_t> u_distr; // change depending on app
+    std::uniform_real_distribution<double> r_distr(0.0, 1.0);
+    std::vector<double> cdf = zipf_cdf(pool_size, zipf_s);
+
+    // File to write time data
+    std::ofstream time_data;
+    time_data.open(argv[1]);
+    time_data << "n,mode,hit_rate,prefix_hits,matches,t_mean,t_stdev,t_Q0,t_Q1,t_Q2,t_Q3,t_Q4" << std::endl;
+
+    // Begin testing
+    std::cout << "\033[0;36mRunning tests...\033[0m" << std::endl << std::endl;
+    executed_runs = 0;
+    for (n = lower; n <= upper; n += step) {
+        // Vector of text files
+        std::string path = "/home/dataset/";
+        std::vector<std::string> text_files = {"sources", "dna", "proteins", "GCF_000001405.40_GRCh38.p14_genomic.fna"};
+        std::string dataset = text_files[n-1];
+
+        // Load text
+        std::string text = load_sequences({path+dataset}).text;
+        suffix_array sa(text);
+
+        // Pool of distinct text positions, queried with Zipf popularity.
+        // Each query takes a prefix of random length of its pool entry, so
+        // queries at one position share prefixes, as refinements of a
+        // search do, and the cache's prefix narrowing gets exercised
+        std::int64_t max_length = 32;
+        std::uniform_int_distribution<std::int64_t> length_distr(8, max_length);
+        std::vector<std::string> pool(pool_size);
+        for (i = 0; i < pool_size; i++)
+            pool[i] = get_random_pattern(text, rng, u_distr, max_length);
+
+        std::vector<std::string> stream(runs);
+        for (i = 0; i < runs; i++) {
+            std::int64_t rank = std::lower_bound(cdf.begin(), cdf.end(), r_distr(rng)) - cdf.begin();
+            stream[i] = pool[std::min(rank, pool_size - 1)].substr(0, length_distr(rng));
+        }
+
+        double hit_rate = 0;
+        std::int64_t prefix_hits = 0;
+        time_stream(dataset, "uncached", [&](const std::string& p) { return sa.count(p); },
+            stream, time_data, executed_runs, total_runs_additive, hit_rate, prefix_hits);
+
+        query_cache<suffix_array> cache(sa, cache_capacity);
+        time_stream(dataset, "cached", [&](const std::string& p) {
+                std::int64_t c = cache.count(p);
+                hit_rate = cache.hit_rate();
+                prefix_hits = cache.prefix_hit_count();
+                return c;
+            }, stream, time_data, executed_runs, total_runs_additive, hit_rate, prefix_hits);
+    }
+
+    // This is to keep loading bar after testing
+    std::cout << std::endl << std::endl;
+    std::cout << "\033[1;32mDone!\033[0m" << std::endl;
+
+    time_data.close();
+
+    return 0;
+}
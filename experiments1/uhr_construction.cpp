@@ -0,0 +1,202 @@
+/** uhr: generic time performance tester
+ * Author: LELE
+ *
+ * Things to set up:
+ * 0. Includes: include all files to be tested,
+ * 1. Time unit: in elapsed_time,
+ * 2. What to write on time_data,
+ * 3. Data type and distribution of RNG,
+ * 4. Additive or multiplicative stepping,
+ * 5. The experiments: in outer for loop. */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sstream>
+
+// Include to be tested files here
+#include "../src/suffix_array.cpp"
+#include "../src/sa_construction.cpp"
+#include "../src/lcp_construction.cpp"
+#include "../src/memory_tracker.cpp"
+#include "../src/text_loader.cpp"
+#include "../src/build_trace.cpp"
+#include "../src/uhr_harness.cpp"
+
+int main(int argc, char *argv[])
+{
+    // Validate and sanitize input
+    // Here <RUNS> is the number of builds per backend and dataset
+    std::int64_t runs, lower, upper, step;
+    validate_input(argc, argv, runs, lower, upper, step,
+        {{}, {"<TRACE>"}, {"<TRACE>: optional Chrome trace JSON file for the construction phases."}});
+
+    // Backends to compare; the first one is the reference output
+    std::vector<std::pair<std::string, sa_construction>> methods = {
+        {"original_doubling", sa_construction::original_doubling},
+        {"doubling", sa_construction::doubling},
+        {"packed_doubling", sa_construction::packed_doubling},
+#if SA_HAS_DIVSUFSORT
+        {"divsufsort", sa_construction::divsufsort},
+#endif
+    };
+
+    std::int64_t n, i, executed_runs;
+    // LCP builders, run on the reference SA
+    std::vector<std::pair<std::string, std::int64_t>> lcp_methods = {
+        {"lcp_kasai", 1},
+        {"lcp_phi_parallel", default_threads()},
+    };
+
+    std::int64_t total_runs_additive = (methods.size() + lcp_methods.size()) * runs * (((upper - lower) / step) + 1);
+    std::vector<double> times(runs);
+    std::vector<double> q;
+    double mean_time, time_stdev, dev;
+    auto begin_time = std::chrono::high_resolution_clock::now();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::nano> elapsed_time = end_time - begin_time;
+
+    // File to write time data
+    std::ofstream time_data;
+    time_data.open(argv[1]);
+    // rounds, touched: doubling rounds and suffixes sorted in them, per build
+    time_data << "n,method,t_mean,t_stdev,t_Q0,t_Q1,t_Q2,t_Q3,t_Q4,peak_heap,identical,rounds,touched" << std::endl;
+
+    // Phase events of every build, when a trace file is given
+    std::ofstream trace_file;
+    std::unique_ptr<chrome_trace> trace;
+    std::optional<trace_session> session;
+    if (argc == 7) {
+        trace_file.open(argv[6]);
+        trace = std::make_unique<chrome_trace>(trace_file);
+        session.emplace(trace->tracer());
+    }
+
+    // Begin testing
+    std::cout << "\033[0;36mRunning tests...\033[0m" << std::endl << std::endl;
+    executed_runs = 0;
+    for (n = lower; n <= upper; n += step) {
+        // Vector of text files
+        std::string path = "/home/dataset/";
+        std::vector<std::string> text_files = {"sources", "dna", "proteins", "GCF_000001405.40_GRCh38.p14_genomic.fna"};
+
+        // Load text, with the ETX the SA classes append
+        std::string text = load_sequences({path+text_files[n-1]}).text;
+        char ETX = 3;
+        text += ETX;
+
+        std::vector<std::int64_t> reference;
+        for (auto& [name, method] : methods) {
+            mean_time = 0;
+            time_stdev = 0;
+            std::int64_t peak_heap = 0;
+            std::vector<std::int64_t> SA(text.size());
+            construction_arena arena; // Reused across runs of one method
+            construction_stats stats;
+
+            for (i = 0; i < runs; i++) {
+                display_progress(++executed_runs, total_runs_additive);
+
+                trace_scope build(name.c_str(), {{"dataset", n}, {"run", i}});
+                memory_phase construct_phase;
+                begin_time = std::chrono::high_resolution_clock::now();
+                stats = {};
+                build_sa(text, SA, method, &arena, 1, &stats);
+                end_time = std::chrono::high_resolution_clock::now();
+                peak_heap = std::max(peak_heap, construct_phase.finish().peak_heap);
+
+                elapsed_time = end_time - begin_time;
+                times[i] = elapsed_time.count();
+                mean_time += times[i];
+            }
+
+            if (reference.empty())
+                reference = SA;
+
+            // Compute statistics
+            mean_time /= runs;
+
+            for (i = 0; i < runs; i++) {
+                dev = times[i] - mean_time;
+                time_stdev += dev * dev;
+            }
+
+            time_stdev /= runs - 1; // Subtract 1 to get unbiased estimator
+            time_stdev = std::sqrt(time_stdev);
+
+            quartiles(times, q);
+
+            time_data << text_files[n-1] << "," << name << "," << mean_time << "," << time_stdev << ",";
+            time_data << q[0] << "," << q[1] << "," << q[2] << "," << q[3] << "," << q[4] << ",";
+            time_data << peak_heap << "," << (SA == reference) << ",";
+            time_data << stats.rounds << "," << stats.elements_touched << std::endl;
+        }
+
+        std::vector<std::int64_t> reference_lcp;
+        for (auto& [name, threads] : lcp_methods) {
+            mean_time = 0;
+            time_stdev = 0;
+            std::int64_t peak_heap = 0;
+            std::vector<std::int64_t> LCP(text.size());
+            construction_arena arena; // Reused across runs of one method
+
+            for (i = 0; i < runs; i++) {
+                display_progress(++executed_runs, total_runs_additive);
+
+                trace_scope build(name.c_str(), {{"dataset", n}, {"run", i}});
+                memory_phase construct_phase;
+                begin_time = std::chrono::high_resolution_clock::now();
+                build_lcp(text, reference, LCP, threads, &arena);
+                end_time = std::chrono::high_resolution_clock::now();
+                peak_heap = std::max(peak_heap, construct_phase.finish().peak_heap);
+
+                elapsed_time = end_time - begin_time;
+                times[i] = elapsed_time.count();
+                mean_time += times[i];
+            }
+
+            if (reference_lcp.empty())
+                reference_lcp = LCP;
+
+            // Compute statistics
+            mean_time /= runs;
+
+            for (i = 0; i < runs; i++) {
+                dev = times[i] - mean_time;
+                time_stdev += dev * dev;
+            }
+
+            time_stdev /= runs - 1; // Subtract 1 to get unbiased estimator
+            time_stdev = std::sqrt(time_stdev);
+
+            quartiles(times, q);
+
+            time_data << text_files[n-1] << "," << name << "," << mean_time << "," << time_stdev << ",";
+            time_data << q[0] << "," << q[1] << "," << q[2] << "," << q[3] << "," << q[4] << ",";
+            time_data << peak_heap << "," << (LCP == reference_lcp) << ",0,0" << std::endl;
+        }
+    }
+
+    // This is to keep loading bar after testing
+    std::cout << std::endl << std::endl;
+    std::cout << "\033[1;32mDone!\033[0m" << std::endl;
+
+    time_data.close();
+    // The trace is closed after its last event
+    session.reset();
+    trace.reset();
+
+    return 0;
+}
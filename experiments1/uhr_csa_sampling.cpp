@@ -0,0 +1,154 @@
+/** uhr: generic time performance tester
+ * Author: LELE
+ *
+ * Things to set up:
+ * 0. Includes: include all files to be tested,
+ * 1. Time unit: in elapsed_time,
+ * 2. What to write on time_data,
+ * 3. Data type and distribution of RNG,
+ * 4. Additive or multiplicative stepping,
+ * 5. The experiments: in outer for loop. */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sstream>
+
+// Include to be tested files here
+#include "../src/suffix_array.cpp"
+#include "../src/suffix_array_lcp.cpp"
+#include "../src/suffix_array_sdsl.cpp"
+#include "../src/fmindex.cpp"
+#include "../src/text_loader.cpp"
+#include "../src/uhr_harness.cpp"
+
+// Time locate and extract on one sampling configuration and write a row
+template <class Index>
+void run_configuration(const std::string& dataset, const std::string& config, const std::string& text,
+    const std::vector<std::string>& patterns, const std::vector<std::int64_t>& extract_starts,
+    std::int64_t extract_length, std::ofstream& time_data, std::int64_t& executed_runs, std::int64_t total_runs)
+{
+    std::int64_t runs = patterns.size();
+    std::int64_t i, occurrences = 0, extracted = 0;
+    std::vector<double> locate_times(runs), extract_times(runs);
+    std::vector<double> lq, eq;
+    double locate_mean = 0, extract_mean = 0;
+    auto begin_time = std::chrono::high_resolution_clock::now();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::nano> elapsed_time;
+
+    begin_time = std::chrono::high_resolution_clock::now();
+    Index index(text);
+    end_time = std::chrono::high_resolution_clock::now();
+    elapsed_time = end_time - begin_time;
+    double construct_time = elapsed_time.count();
+
+    for (i = 0; i < runs; i++) {
+        display_progress(++executed_runs, total_runs);
+
+        begin_time = std::chrono::high_resolution_clock::now();
+        auto occs = index.locate(patterns[i]);
+        end_time = std::chrono::high_resolution_clock::now();
+        elapsed_time = end_time - begin_time;
+        locate_times[i] = elapsed_time.count();
+        locate_mean += locate_times[i];
+        occurrences += occs.size();
+
+        begin_time = std::chrono::high_resolution_clock::now();
+        std::string snippet = index.extract(extract_starts[i], extract_starts[i] + extract_length - 1);
+        end_time = std::chrono::high_resolution_clock::now();
+        elapsed_time = end_time - begin_time;
+        extract_times[i] = elapsed_time.count();
+        extract_mean += extract_times[i];
+        extracted += snippet.size();
+    }
+
+    locate_mean /= runs;
+    extract_mean /= runs;
+    quartiles(locate_times, lq);
+    quartiles(extract_times, eq);
+
+    time_data << dataset << "," << config << "," << index.size_in_bytes() << "," << construct_time << ",";
+    time_data << occurrences << "," << extracted << "," << locate_mean << "," << lq[2] << "," << lq[3] << ",";
+    time_data << extract_mean << "," << eq[2] << "," << eq[3] << std::endl;
+}
+
+using wt_rrr = sdsl::wt_huff<sdsl::rrr_vector<127> >;
+using wt_plain = sdsl::wt_huff<>;
+
+int main(int argc, char *argv[])
+{
+    // Validate and sanitize input
+    std::int64_t runs, lower, upper, step;
+    validate_input(argc, argv, runs, lower, upper, step);
+
+    // One run per configuration and pattern
+    const std::int64_t configurations = 10;
+    std::int64_t n, i, executed_runs;
+    std::int64_t total_runs_additive = configurations * runs * (((upper - lower) / step) + 1);
+
+    // Set up random number generation
+    std::random_device rd;
+    std::mt19937_64 rng(rd());
+    std::uniform_int_distribution<std::int64_t> u_distr; // change depending on app
+
+    // File to write time data, one row per (dataset, configuration)
+    // Plot locate/extract latency against size to find the Pareto front
+    std::ofstream time_data;
+    time_data.open(argv[1]);
+    time_data << "n,config,space,construct_time,occurrences,extracted,locate_mean,locate_Q2,locate_Q3,";
+    time_data << "extract_mean,extract_Q2,extract_Q3" << std::endl;
+
+    // Begin testing
+    std::cout << "\033[0;36mRunning tests...\033[0m" << std::endl << std::endl;
+    executed_runs = 0;
+    for (n = lower; n <= upper; n += step) {
+        // Vector of text files
+        std::string path = "/home/dataset/";
+        std::vector<std::string> text_files = {"sources", "dna", "proteins", "GCF_000001405.40_GRCh38.p14_genomic.fna"};
+        std::string dataset = text_files[n-1];
+
+        // Load text
+        std::string text = load_sequences({path+dataset}).text;
+
+        // Same patterns and extract positions for every configuration
+        std::int64_t pattern_length = 15;
+        std::int64_t extract_length = 64;
+        std::vector<std::string> patterns(runs);
+        std::vector<std::int64_t> extract_starts(runs);
+        for (i = 0; i < runs; i++) {
+            patterns[i] = get_random_pattern(text, rng, u_distr, pattern_length);
+            extract_starts[i] = u_distr(rng) % (text.size() - extract_length);
+        }
+
+        // SA/ISA sample densities and wavelet tree type to sweep
+        run_configuration<fmindex<wt_rrr, 32, 64> >(dataset, "fm_rrr_32_64", text, patterns, extract_starts, extract_length, time_data, executed_runs, total_runs_additive);
+        run_configuration<fmindex<wt_rrr, 128, 256> >(dataset, "fm_rrr_128_256", text, patterns, extract_starts, extract_length, time_data, executed_runs, total_runs_additive);
+        run_configuration<fmindex<wt_rrr, 512, 1024> >(dataset, "fm_rrr_512_1024", text, patterns, extract_starts, extract_length, time_data, executed_runs, total_runs_additive);
+        run_configuration<fmindex<wt_rrr, 2048, 4096> >(dataset, "fm_rrr_2048_4096", text, patterns, extract_starts, extract_length, time_data, executed_runs, total_runs_additive);
+        run_configuration<fmindex<wt_plain, 32, 64> >(dataset, "fm_plain_32_64", text, patterns, extract_starts, extract_length, time_data, executed_runs, total_runs_additive);
+        run_configuration<fmindex<wt_plain, 512, 1024> >(dataset, "fm_plain_512_1024", text, patterns, extract_starts, extract_length, time_data, executed_runs, total_runs_additive);
+        run_configuration<sdsl_suffix_array<wt_plain, 4, 8> >(dataset, "csa_plain_4_8", text, patterns, extract_starts, extract_length, time_data, executed_runs, total_runs_additive);
+        run_configuration<sdsl_suffix_array<wt_plain, 16, 32> >(dataset, "csa_plain_16_32", text, patterns, extract_starts, extract_length, time_data, executed_runs, total_runs_additive);
+        run_configuration<sdsl_suffix_array<wt_plain, 32, 64> >(dataset, "csa_plain_32_64", text, patterns, extract_starts, extract_length, time_data, executed_runs, total_runs_additive);
+        run_configuration<sdsl_suffix_array<wt_rrr, 32, 64> >(dataset, "csa_rrr_32_64", text, patterns, extract_starts, extract_length, time_data, executed_runs, total_runs_additive);
+    }
+
+    // This is to keep loading bar after testing
+    std::cout << std::endl << std::endl;
+    std::cout << "\033[1;32mDone!\033[0m" << std::endl;
+
+    time_data.close();
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/** uhr: generic time performance tester
+ * Author: LELE
+ *
+ * Things to set up:
+ * 0. Includes: include all files to be tested,
+ * 1. Time unit: in elapsed_time,
+ * 2. What to write on time_data,
+ * 3. Data type and distribution of RNG,
+ * 4. Additive or multiplicative stepping,
+ * 5. The experiments: in outer for loop. */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sstream>
+
+// Include to be tested files here
+#include "../src/suffix_array.cpp"
+#include "../src/perf_counter.cpp"
+#include "../src/text_loader.cpp"
+#include "../src/uhr_harness.cpp"
+
+int main(int argc, char *argv[])
+{
+    // Validate and sanitize input
+    // Here <RUNS> is the number of distinct patterns queried per policy
+    std::int64_t runs, lower, upper, step;
+    validate_input(argc, argv, runs, lower, upper, step);
+
+    // Page size and NUMA placement of the SA to compare
+    std::vector<memory_policy> policies = {
+        {page_policy::standard, numa_policy::local},
+        {page_policy::transparent_huge, numa_policy::local},
+        {page_policy::explicit_huge, numa_policy::local},
+        {page_policy::standard, numa_policy::interleave},
+        {page_policy::transparent_huge, numa_policy::interleave},
+    };
+
+    std::int64_t n, i, executed_runs;
+    std::int64_t total_runs_additive = policies.size() * runs * (((upper - lower) / step) + 1);
+    std::vector<double> times(runs);
+    std::vector<double> q;
+    double mean_time, time_stdev, dev;
+    auto begin_time = std::chrono::high_resolution_clock::now();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::nano> elapsed_time = end_time - begin_time;
+
+    // Set up random number generation
+    std::random_device rd;
+    std::mt19937_64 rng(rd());
+    std::uniform_int_distribution<std::int64_t> u_distr; // change depending on app
+
+    // File to write time data
+    std::ofstream time_data;
+    time_data.open(argv[1]);
+    time_data << "n,policy,t_mean,t_stdev,t_Q0,t_Q1,t_Q2,t_Q3,t_Q4,dtlb_misses_per_query" << std::endl;
+
+    perf_counter dtlb(PERF_TYPE_HW_CACHE, dtlb_load_misses);
+    if (!dtlb.valid())
+        std::cerr << "dTLB counter unavailable, reporting -1" << std::endl;
+
+    // Begin testing
+    std::cout << "\033[0;36mRunning tests...\033[0m" << std::endl << std::endl;
+    executed_runs = 0;
+    for (n = lower; n <= upper; n += step) {
+        // Vector of text files
+        std::string path = "/home/dataset/";
+        std::vector<std::string> text_files = {"sources", "dna", "proteins", "GCF_000001405.40_GRCh38.p14_genomic.fna"};
+
+        // Load text
+        std::string text = load_sequences({path+text_files[n-1]}).text;
+
+        // Distinct random patterns, so lookups do not hit warm lines
+        std::int64_t pattern_length = 15;
+        std::vector<std::string> patterns(runs);
+        for (i = 0; i < runs; i++)
+            patterns[i] = get_random_pattern(text, rng, u_distr, pattern_length);
+
+        for (const auto& policy : policies) {
+            mean_time = 0;
+            time_stdev = 0;
+            std::int64_t matches = 0, misses = 0;
+
+            suffix_array sa(text, sa_construction::packed_doubling, default_threads(), policy);
+
+            for (i = 0; i < runs; i++) {
+                display_progress(++executed_runs, total_runs_additive);
+
+                dtlb.start();
+                begin_time = std::chrono::high_resolution_clock::now();
+                matches += sa.count(patterns[i]);
+                end_time = std::chrono::high_resolution_clock::now();
+                misses += dtlb.stop();
+
+                elapsed_time = end_time - begin_time;
+                times[i] = elapsed_time.count();
+                mean_time += times[i];
+            }
+
+            // Compute statistics
+            mean_time /= runs;
+
+            for (i = 0; i < runs; i++) {
+                dev = times[i] - mean_time;
+                time_stdev += dev * dev;
+            }
+
+            time_stdev /= runs - 1; // Subtract 1 to get unbiased estimator
+            time_stdev = std::sqrt(time_stdev);
+
+            quartiles(times, q);
+
+            time_data << text_files[n-1] << "," << policy_name(policy) << "," << mean_time << "," << time_stdev << ",";
+            time_data << q[0] << "," << q[1] << "," << q[2] << "," << q[3] << "," << q[4] << ",";
+            time_data << (dtlb.valid() ? double(misses) / runs : -1.0) << std::endl;
+            std::cout << std::endl << policy_name(policy) << ": " << matches << " matches" << std::endl;
+        }
+    }
+
+    // This is to keep loading bar after testing
+    std::cout << std::endl << std::endl;
+    std::cout << "\033[1;32mDone!\033[0m" << std::endl;
+
+    time_data.close();
+
+    return 0;
+}
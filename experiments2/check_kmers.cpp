@@ -0,0 +1,127 @@
+/** Checks kmer_index against suffix_array_lcp::count.
+ * Usage: ./check_kmers <TEXT> [<PREFIX>]
+ *
+ * Indexes the first <PREFIX> characters of <TEXT> (100000 by default) and,
+ * for k in {1, 2, 4, 8, 16, 32}, builds the k-mer table, serializes it and
+ * loads it back. For every k-mer of the text, both tables must give the
+ * count of the index; k-mers absent from the text and patterns of another
+ * length must give 0. Tables with a corrupt header or slots, or loaded
+ * against another text of the same length, must be rejected by load().
+ * Exits with failure on the first mismatch. */
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../src/kmer_index.cpp"
+#include "../src/text_loader.cpp"
+
+// Whether load() refuses the serialized table after patch(bytes)
+template <class Patch>
+bool rejected(const std::string& serialized, std::string_view text, Patch&& patch)
+{
+    std::string bytes = serialized;
+    patch(bytes);
+    std::istringstream in(bytes);
+    try {
+        kmer_index::load(in, text);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: <TEXT> [<PREFIX>]" << std::endl;
+        std::cerr << "<TEXT>: file to index." << std::endl;
+        std::cerr << "<PREFIX>: characters of <TEXT> to index, 100000 by default." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::int64_t prefix = argc == 3 ? std::stoll(argv[2]) : 100000;
+    std::string text = load_sequences({argv[1]}).text.substr(0, prefix);
+    suffix_array_lcp<> index(text);
+
+    auto fail = [](std::int64_t k, const std::string& what) {
+        std::cerr << "k = " << k << ": " << what << std::endl;
+        return EXIT_FAILURE;
+    };
+
+    for (std::int64_t k : {1, 2, 4, 8, 16, 32}) {
+        if (k > static_cast<std::int64_t>(text.size()))
+            break;
+
+        kmer_index built(index, k);
+        std::stringstream buffer;
+        built.serialize(buffer);
+        std::string serialized = buffer.str();
+        kmer_index loaded = kmer_index::load(buffer, index.text());
+
+        std::set<std::string_view> kmers;
+        for (std::size_t i = 0; i + k <= text.size(); i++) {
+            std::string_view kmer = index.text().substr(i, k);
+            std::int64_t expected = index.count(kmer);
+            if (built.count(kmer) != expected || loaded.count(kmer) != expected)
+                return fail(k, "count differs on \"" + std::string(kmer) + "\"");
+            kmers.insert(kmer);
+        }
+        if (built.size() != static_cast<std::int64_t>(kmers.size()) || loaded.size() != built.size())
+            return fail(k, "table has " + std::to_string(built.size()) + " k-mers, text has " +
+                               std::to_string(kmers.size()));
+
+        // Absent k-mers, and lengths other than k
+        std::string absent(k, '\x01');
+        std::string longer = std::string(text.substr(0, k)) + "x";
+        if (built.count(absent) != 0 || loaded.count(absent) != 0 || loaded.count(longer) != 0 ||
+            loaded.count(text.substr(0, k - 1)) != 0)
+            return fail(k, "absent pattern found");
+
+        // Header is magic, then k, distinct, slot count; slots follow
+        const std::size_t distinct_at = 16, slots_at = 24, first_slot = 32, slot_size = 32;
+        auto set_field = [](std::string& bytes, std::size_t at, std::int64_t value) {
+            bytes.replace(at, sizeof(value), reinterpret_cast<const char *>(&value), sizeof(value));
+        };
+        auto get_field = [](const std::string& bytes, std::size_t at) {
+            std::int64_t value;
+            bytes.copy(reinterpret_cast<char *>(&value), sizeof(value), at);
+            return value;
+        };
+        std::int64_t slots = get_field(serialized, slots_at);
+
+        if (!rejected(serialized, index.text(), [&](std::string& b) { set_field(b, distinct_at, slots / 2); }) ||
+            !rejected(serialized, index.text(), [&](std::string& b) { set_field(b, distinct_at, -1); }))
+            return fail(k, "load accepts a table without room for an empty slot");
+        if (!rejected(serialized, index.text(), [&](std::string& b) {
+                // Fill the first empty slot, so the slots disagree with the header
+                std::size_t at = first_slot;
+                while (get_field(b, at + 24) != 0)
+                    at += slot_size;
+                set_field(b, at + 24, 1);
+            }))
+            return fail(k, "load accepts more used slots than distinct k-mers");
+
+        if (!rejected(serialized, index.text(), [&](std::string& b) {
+                // Push the SA interval of the first used slot past the last row
+                std::size_t at = first_slot;
+                while (get_field(b, at + 24) == 0)
+                    at += slot_size;
+                set_field(b, at + 16, text.size() + 1);
+            }))
+            return fail(k, "load accepts an SA interval outside the index");
+        std::string other(text.rbegin(), text.rend());
+        if (other != text && !rejected(serialized, other, [](std::string&) {}))
+            return fail(k, "load accepts a different text of the same length");
+
+        std::cout << "k = " << k << ": " << built.size() << " k-mers, " << built.size_in_bytes() << " bytes" << std::endl;
+    }
+
+    std::cout << "\033[1;32mDone!\033[0m" << std::endl;
+    return 0;
+}
@@ -0,0 +1,157 @@
+/** Checks the repeat queries of suffix_array_lcp against brute force.
+ * Usage: ./check_repeats [<TEXT>]
+ *
+ * On a few short texts with known repeats, and on the first 300
+ * characters of <TEXT> when given, compares:
+ *  - longest_repeat(): occurs twice, and no longer substring does,
+ *  - maximal_repeats(2, fn): the same set as every substring of length
+ *    >= 2 occurring twice whose occurrences all differ on the left and on
+ *    the right,
+ *  - top_substrings(k, 2, 6): the same (occurrences, length) ranking as
+ *    sorting every repeated substring of length in [2, 6],
+ * with occurrences counted by scanning the text. Prints the repeats found
+ * and exits with failure on the first mismatch. */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../src/suffix_array_lcp.cpp"
+
+// Occurrences of s in text, overlapping ones included
+std::int64_t naive_count(const std::string& text, const std::string& s)
+{
+    std::int64_t occurrences = 0;
+    for (std::size_t p = text.find(s); p != std::string::npos; p = text.find(s, p + 1))
+        occurrences++;
+    return occurrences;
+}
+
+// Every distinct substring of text occurring at least twice
+std::set<std::string> naive_repeats(const std::string& text)
+{
+    std::set<std::string> repeats;
+    for (std::size_t i = 0; i < text.size(); i++)
+        for (std::size_t m = 1; i + m <= text.size(); m++) {
+            std::string s = text.substr(i, m);
+            if (naive_count(text, s) < 2)
+                break;
+            repeats.insert(s);
+        }
+    return repeats;
+}
+
+bool check(const std::string& name, const std::string& text)
+{
+    suffix_array_lcp<> index(text);
+    std::set<std::string> repeats = naive_repeats(text);
+    std::set<char> alphabet(text.begin(), text.end());
+
+    auto fail = [&](const std::string& what) {
+        std::cerr << name << ": " << what << std::endl;
+        return false;
+    };
+
+    // Longest repeat
+    auto [position, length] = index.longest_repeat();
+    std::size_t longest = 0;
+    for (const auto& s : repeats)
+        longest = std::max(longest, s.size());
+    if (static_cast<std::size_t>(length) != longest)
+        return fail("longest_repeat has length " + std::to_string(length) + ", expected " + std::to_string(longest));
+    if (length > 0 && naive_count(text, text.substr(position, length)) < 2)
+        return fail("longest_repeat does not repeat");
+
+    // Maximal repeats: no extension by one character keeps every occurrence
+    std::set<std::string> expected, found;
+    for (const auto& s : repeats) {
+        std::int64_t occurrences = naive_count(text, s);
+        bool maximal = s.size() >= 2;
+        for (char c : alphabet)
+            if (naive_count(text, s + c) == occurrences || naive_count(text, c + s) == occurrences)
+                maximal = false;
+        if (maximal)
+            expected.insert(s);
+    }
+    bool counts_match = true;
+    index.maximal_repeats(2, [&](std::int64_t p, std::int64_t m, std::int64_t occurrences) {
+        std::string s = text.substr(p, m);
+        counts_match = counts_match && naive_count(text, s) == occurrences;
+        found.insert(s);
+    });
+    if (!counts_match)
+        return fail("maximal_repeats reports wrong occurrences");
+    if (found != expected)
+        return fail("maximal_repeats finds " + std::to_string(found.size()) + " repeats, expected " +
+                    std::to_string(expected.size()));
+
+    // Top substrings: same ranking, ties broken by any position
+    const std::int64_t k = 5, min_length = 2, max_length = 6;
+    std::vector<std::pair<std::int64_t, std::int64_t>> ranking; // (occurrences, length)
+    for (const auto& s : repeats)
+        if (static_cast<std::int64_t>(s.size()) >= min_length && static_cast<std::int64_t>(s.size()) <= max_length)
+            ranking.emplace_back(naive_count(text, s), s.size());
+    std::sort(ranking.rbegin(), ranking.rend());
+    ranking.resize(std::min<std::size_t>(k, ranking.size()));
+
+    auto top = index.top_substrings(k, min_length, max_length);
+    if (top.size() != ranking.size())
+        return fail("top_substrings returns " + std::to_string(top.size()) + " substrings, expected " +
+                    std::to_string(ranking.size()));
+    for (std::size_t i = 0; i < top.size(); i++) {
+        auto [s, occurrences] = top[i];
+        if (naive_count(text, s) != occurrences ||
+            ranking[i] != std::pair<std::int64_t, std::int64_t>(occurrences, s.size()))
+            return fail("top_substrings differs at rank " + std::to_string(i) + " (\"" + s + "\")");
+    }
+
+    std::cout << name << ": longest repeat \"" << text.substr(position, length) << "\", "
+              << found.size() << " maximal repeats, top:";
+    for (const auto& [s, occurrences] : top)
+        std::cout << " \"" << s << "\"x" << occurrences;
+    std::cout << std::endl;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 2) {
+        std::cerr << "Usage: <TEXT>" << std::endl;
+        std::cerr << "<TEXT>: optional file whose first 300 characters are checked too." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::pair<std::string, std::string>> texts = {
+        {"mississippi", "mississippi"},
+        {"abracadabra", "abracadabra abracadabra"},
+        {"banana", "banana bandana ananas"},
+        {"periodic", "abcabcabcabcab"},
+        {"unary", "aaaaaaa"},
+        {"no repeats", "abcdefg"},
+    };
+    if (argc == 2) {
+        std::ifstream file(argv[1], std::ios::binary);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        if (!file) {
+            std::cerr << "Cannot open file: " << argv[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+        texts.emplace_back(argv[1], buffer.str().substr(0, 300));
+    }
+
+    for (const auto& [name, text] : texts)
+        if (!check(name, text))
+            return EXIT_FAILURE;
+
+    std::cout << "\033[1;32mDone!\033[0m" << std::endl;
+    return 0;
+}
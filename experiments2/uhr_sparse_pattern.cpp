@@ -0,0 +1,147 @@
+/** uhr: generic time performance tester
+ * Author: LELE
+ *
+ * Things to set up:
+ * 0. Includes: include all files to be tested,
+ * 1. Time unit: in elapsed_time,
+ * 2. What to write on time_data,
+ * 3. Data type and distribution of RNG,
+ * 4. Additive or multiplicative stepping,
+ * 5. The experiments: in outer for loop. */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sstream>
+
+// Include to be tested files here
+#include "../src/sparse_suffix_array.cpp"
+#include "../src/text_loader.cpp"
+#include "../src/uhr_harness.cpp"
+
+int main(int argc, char *argv[])
+{
+    // Validate and sanitize input
+    // Here <LOWER> <UPPER> <STEP> are pattern lengths
+    std::int64_t runs, lower, upper, step;
+    validate_input(argc, argv, runs, lower, upper, step);
+
+    // Sampling steps to compare; q = 1 is the full suffix array
+    std::vector<std::int64_t> samplings = {1, 4, 16, 64, 256};
+
+    // Set up clock variables
+    std::int64_t n, i, executed_runs;
+    std::int64_t total_runs_additive = samplings.size() * runs * (((upper - lower) / step) + 1);
+    std::vector<double> times(runs);
+    std::vector<double> q;
+    double mean_time, time_stdev, dev;
+    auto begin_time = std::chrono::high_resolution_clock::now();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::nano> elapsed_time = end_time - begin_time;
+
+    // Fixed seed: every q is measured on the same patterns
+    std::mt19937_64 rng(42);
+
+    // File to write time data
+    std::ofstream time_data;
+    time_data.open(argv[1]);
+    // scan: the pattern is shorter than q, so count() scans the text
+    time_data << "q,n,t_mean,t_stdev,t_Q0,t_Q1,t_Q2,t_Q3,t_Q4,space,scan,matches" << std::endl;
+
+    std::ofstream construct_data;
+    construct_data.open("construct_data_sparse.csv");
+    construct_data << "q,time,space" << std::endl;
+
+    // Vector of text files
+    std::string path = "/home/dataset/";
+    std::vector<std::string> text_files = {"sources"};
+
+    // Load text
+    std::string text = load_sequences({path+text_files[0]}).text;
+    if (static_cast<std::int64_t>(text.size()) <= upper) {
+        std::cerr << "<UPPER> must be smaller than the text." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Patterns occur in the text, so every q verifies the same candidates
+    std::vector<std::string> patterns;
+    for (n = lower; n <= upper; n += step) {
+        std::uniform_int_distribution<std::int64_t> start(0, text.size() - n);
+        patterns.push_back(text.substr(start(rng), n));
+    }
+
+    // Begin testing
+    std::cout << "\033[0;36mRunning tests...\033[0m" << std::endl << std::endl;
+    executed_runs = 0;
+
+    // Matches per pattern with q = 1, which every q must reproduce
+    std::vector<std::int64_t> reference;
+    for (std::int64_t sampling : samplings) {
+        begin_time = std::chrono::high_resolution_clock::now();
+        sparse_suffix_array sa(text, sampling);
+        end_time = std::chrono::high_resolution_clock::now();
+        elapsed_time = end_time - begin_time;
+        construct_data << sampling << "," << elapsed_time.count() << "," << sa.size_in_bytes() << std::endl;
+
+        for (std::size_t p = 0; p < patterns.size(); p++) {
+            const std::string& pattern = patterns[p];
+            std::int64_t matches = 0;
+            mean_time = 0;
+            time_stdev = 0;
+
+            for (i = 0; i < runs; i++) {
+                display_progress(++executed_runs, total_runs_additive);
+
+                begin_time = std::chrono::high_resolution_clock::now();
+                matches = sa.count(pattern);
+                end_time = std::chrono::high_resolution_clock::now();
+
+                elapsed_time = end_time - begin_time;
+                times[i] = elapsed_time.count();
+
+                mean_time += times[i];
+            }
+
+            // Compute statistics
+            mean_time /= runs;
+
+            for (i = 0; i < runs; i++) {
+                dev = times[i] - mean_time;
+                time_stdev += dev * dev;
+            }
+
+            time_stdev /= runs - 1; // Subtract 1 to get unbiased estimator
+            time_stdev = std::sqrt(time_stdev);
+
+            quartiles(times, q);
+
+            time_data << sampling << "," << pattern.size() << "," << mean_time << "," << time_stdev << ",";
+            time_data << q[0] << "," << q[1] << "," << q[2] << "," << q[3] << "," << q[4] << ",";
+            time_data << sa.size_in_bytes() << "," << (static_cast<std::int64_t>(pattern.size()) < sampling) << ",";
+            time_data << matches << std::endl;
+
+            if (reference.size() < patterns.size())
+                reference.push_back(matches);
+            else if (matches != reference[p])
+                std::cerr << std::endl << "q = " << sampling << " finds " << matches << " matches of a pattern of length "
+                          << pattern.size() << ", q = 1 finds " << reference[p] << std::endl;
+        }
+    }
+
+    // This is to keep loading bar after testing
+    std::cout << std::endl << std::endl;
+    std::cout << "\033[1;32mDone!\033[0m" << std::endl;
+    time_data.close();
+
+    return 0;
+}
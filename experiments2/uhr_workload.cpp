@@ -0,0 +1,145 @@
+/** Streaming workload driver.
+ *
+ * Streams patterns from a file (one per line) or from a generator over the
+ * indexed text, runs count() on each and reports throughput and a latency
+ * histogram. Patterns are never held in memory all at once. Each run
+ * appends one row to the summary CSV, whose header is written when the
+ * file is created, so runs over several indexes and sources add up. */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Include to be tested files here
+#include "../src/text_index.cpp"
+#include "../src/suffix_array.cpp"
+#include "../src/suffix_array_lcp.cpp"
+#include "../src/workload.cpp"
+#include "../src/text_loader.cpp"
+
+inline void usage()
+{
+    std::cerr << "Usage: <filename> <SUMMARY> <TEXT> <INDEX> <SOURCE> <QUERIES> [<LENGTHS> <LENGTH> <MIN> <MAX>]"
+              << std::endl;
+    std::cerr << "<filename>: CSV where the latency histogram will be written." << std::endl;
+    std::cerr << "<SUMMARY>: CSV where a row of throughput and latency quantiles is appended." << std::endl;
+    std::cerr << "<TEXT>: file to index." << std::endl;
+    std::cerr << "<INDEX>: sa or salcp." << std::endl;
+    std::cerr << "<SOURCE>: uniform, zipf, absent, mutated, or a pattern file (one per line)." << std::endl;
+    std::cerr << "<QUERIES>: number of generated patterns; ignored for pattern files." << std::endl;
+    std::cerr << "<LENGTHS>: fixed, uniform or normal; <LENGTH> is the fixed length or the mean." << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+template <TextIndex Index, class Next>
+void run_workload(Index& index, Next&& next_pattern, const std::string& label, std::ofstream& histogram_data,
+    std::ofstream& summary)
+{
+    latency_histogram histogram;
+    std::string pattern;
+    std::int64_t matches = 0;
+    double busy_time = 0;
+    auto begin_time = std::chrono::high_resolution_clock::now();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::nano> elapsed_time;
+
+    auto wall_begin = std::chrono::steady_clock::now();
+    while (next_pattern(pattern)) {
+        begin_time = std::chrono::high_resolution_clock::now();
+        matches += index.count(pattern);
+        end_time = std::chrono::high_resolution_clock::now();
+
+        elapsed_time = end_time - begin_time;
+        histogram.add(elapsed_time.count());
+        busy_time += elapsed_time.count();
+    }
+    std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - wall_begin;
+
+    std::int64_t queries = histogram.size();
+    double throughput = queries / (busy_time / 1e9);
+
+    std::cout << label << ": " << queries << " queries, " << matches << " matches" << std::endl;
+    std::cout << "throughput (count only): " << throughput << " queries/s" << std::endl;
+    std::cout << "throughput (with generation): " << queries / wall_time.count() << " queries/s" << std::endl;
+    std::cout << "latency upper bounds (ns): p50 " << histogram.quantile(0.5) << ", p90 " << histogram.quantile(0.9);
+    std::cout << ", p99 " << histogram.quantile(0.99) << ", p99.9 " << histogram.quantile(0.999) << std::endl;
+
+    summary << label << "," << queries << "," << matches << "," << throughput << ",";
+    summary << histogram.quantile(0.5) << "," << histogram.quantile(0.9) << ",";
+    summary << histogram.quantile(0.99) << "," << histogram.quantile(0.999) << std::endl;
+
+    histogram.write_csv(histogram_data);
+}
+
+template <TextIndex Index>
+void run_source(Index& index, const std::string& text, const std::string& source, std::int64_t queries,
+    const workload_config& config, const std::string& label, std::ofstream& histogram_data, std::ofstream& summary)
+{
+    if (source == "uniform" || source == "zipf" || source == "absent" || source == "mutated") {
+        workload_config c = config;
+        c.source = parse_pattern_source(source);
+        workload_generator generator(text, c);
+        std::int64_t generated = 0;
+        run_workload(index, [&](std::string& p) {
+                if (generated++ == queries)
+                    return false;
+                p = generator.next();
+                return true;
+            }, label, histogram_data, summary);
+    } else {
+        pattern_file_reader reader(source);
+        run_workload(index, [&](std::string& p) { return reader.next(p); }, label, histogram_data, summary);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 7 && argc != 11)
+        usage();
+
+    std::string text_file = argv[3], index_name = argv[4], source = argv[5];
+    std::int64_t queries;
+    workload_config config;
+    try {
+        queries = std::stoll(argv[6]);
+        if (argc == 11) {
+            config.lengths = parse_length_distribution(argv[7]);
+            config.length = std::stoll(argv[8]);
+            config.min_length = std::stoll(argv[9]);
+            config.max_length = std::stoll(argv[10]);
+        }
+    } catch (std::exception const& ex) {
+        std::cerr << ex.what() << std::endl;
+        usage();
+    }
+
+    std::ofstream histogram_data(argv[1]);
+    bool created = !std::filesystem::exists(argv[2]) || std::filesystem::is_empty(argv[2]);
+    std::ofstream summary(argv[2], std::ios::app);
+    if (created)
+        summary << "text,index,source,queries,matches,throughput,p50_ns,p90_ns,p99_ns,p999_ns" << std::endl;
+    std::string text = load_sequences({text_file}).text;
+    std::string label = text_file + "," + index_name + "," + source;
+
+    std::cout << "\033[0;36mRunning workload...\033[0m" << std::endl;
+    if (index_name == "sa") {
+        suffix_array sa(text);
+        run_source(sa, text, source, queries, config, label, histogram_data, summary);
+    } else if (index_name == "salcp") {
+        suffix_array_lcp salcp(text);
+        run_source(salcp, text, source, queries, config, label, histogram_data, summary);
+    } else {
+        usage();
+    }
+    std::cout << "\033[1;32mDone!\033[0m" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,316 @@
+/** C++20 coroutine support for asynchronous index queries.
+ *
+ * query_task<T> is a lazy coroutine returning T; it can be co_awaited from
+ * another task or handed to a query_scheduler. Query code marks likely
+ * misses with co_await memory_yield(address): under a scheduler the task
+ * prefetches the address and goes to the back of the ready queue, so the
+ * other tasks run while the line arrives. With page checks enabled (for
+ * indexes mapped from disk), a non-resident page gets MADV_WILLNEED
+ * instead, and the task is only resumed once mincore reports the page in,
+ * or once page_in_timeout has elapsed, so the worker keeps
+ * serving other queries during the page-in instead of faulting on it.
+ * Outside a scheduler memory_yield does not suspend, so get() runs a task
+ * synchronously.
+ *
+ * A scheduler serves one thread; run one per worker thread. */
+
+#ifndef ASYNC_QUERY
+#define ASYNC_QUERY
+
+#include <coroutine>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+class query_scheduler
+{
+private:
+    // A parked coroutine; page is set while it waits for a page-in
+    struct parked {
+        std::coroutine_handle<> handle;
+        const void *page = nullptr;
+        std::chrono::steady_clock::time_point deadline{};
+    };
+
+    // Wait for a page-in before resuming anyway, so a page that never comes
+    // in costs a fault, not a hang. Timed rather than counted in trips
+    // around the queue: with few tasks in flight those take microseconds,
+    // far less than a read from disk
+    static constexpr std::chrono::milliseconds page_in_timeout{10};
+
+    // Ring of parked coroutines; never holds more than the tasks in flight
+    std::vector<parked> ready;
+    std::size_t head = 0, queued = 0;
+    bool check_pages;
+    std::int64_t running = 0;
+    std::int64_t page_ins = 0;
+
+    static const void *page_of(const void *addr)
+    {
+        static const std::uintptr_t page = sysconf(_SC_PAGESIZE);
+        return reinterpret_cast<const void *>(reinterpret_cast<std::uintptr_t>(addr) & ~(page - 1));
+    }
+
+    static query_scheduler *&current_ref()
+    {
+        static thread_local query_scheduler *current = nullptr;
+        return current;
+    }
+
+    static bool resident(const void *addr)
+    {
+        static const std::size_t page = sysconf(_SC_PAGESIZE);
+        unsigned char status = 1;
+        // Unmapped or unsupported: treat as resident and let the access decide
+        if (mincore(const_cast<void *>(page_of(addr)), page, &status) != 0)
+            return true;
+        return status & 1;
+    }
+
+    void enqueue(const parked &entry)
+    {
+        if (queued == ready.size()) {
+            // Unwrap into a larger ring
+            std::vector<parked> grown(std::max<std::size_t>(16, 2 * ready.size()));
+            for (std::size_t i = 0; i < queued; i++)
+                grown[i] = ready[(head + i) % ready.size()];
+            ready.swap(grown);
+            head = 0;
+        }
+        ready[(head + queued++) % ready.size()] = entry;
+    }
+
+public:
+    // check_page_residency: look for non-resident pages before each access
+    explicit query_scheduler(bool check_page_residency = false) : check_pages(check_page_residency)
+    {
+    }
+
+    static query_scheduler *current()
+    {
+        return current_ref();
+    }
+
+    // Parks h until addr is likely to be cheap to read
+    void suspend_on(const void *addr, std::coroutine_handle<> h)
+    {
+        if (check_pages && !resident(addr)) {
+            static const std::size_t page = sysconf(_SC_PAGESIZE);
+            madvise(const_cast<void *>(page_of(addr)), page, MADV_WILLNEED);
+            page_ins++;
+            enqueue({h, page_of(addr), std::chrono::steady_clock::now() + page_in_timeout});
+        } else {
+            __builtin_prefetch(addr);
+            enqueue({h});
+        }
+    }
+
+    void push(std::coroutine_handle<> h)
+    {
+        enqueue({h});
+    }
+
+    void root_done()
+    {
+        running--;
+    }
+
+    // Runs every task to completion, with at most max_in_flight started
+    // but unfinished at any time
+    template <class Task>
+    void run(std::vector<Task> &tasks, std::int64_t max_in_flight = 32)
+    {
+        query_scheduler *previous = std::exchange(current_ref(), this);
+        std::size_t next = 0;
+
+        auto launch = [&] {
+            while (running < max_in_flight && next < tasks.size()) {
+                push(tasks[next++].handle());
+                running++;
+            }
+        };
+
+        launch();
+        while (queued > 0) {
+            parked entry = ready[head];
+            head = (head + 1) % ready.size();
+            queued--;
+            // Still paging in: go round again while others can run
+            if (entry.page && !resident(entry.page) && std::chrono::steady_clock::now() < entry.deadline) {
+                enqueue(entry);
+                continue;
+            }
+            entry.handle.resume();
+            launch();
+        }
+
+        current_ref() = previous;
+    }
+
+    // Suspensions that issued a page-in instead of a prefetch
+    std::int64_t page_in_count() const
+    {
+        return page_ins;
+    }
+};
+
+struct memory_yield {
+    const void *addr;
+
+    bool await_ready() const noexcept
+    {
+        return query_scheduler::current() == nullptr;
+    }
+
+    void await_suspend(std::coroutine_handle<> h) const
+    {
+        query_scheduler::current()->suspend_on(addr, h);
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+};
+
+template <class T>
+class query_task
+{
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        query_task get_return_object()
+        {
+            return query_task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        // Resume whoever awaited this task, or tell the scheduler a root ended
+        struct final_awaiter {
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+            {
+                if (h.promise().continuation)
+                    return h.promise().continuation;
+                if (query_scheduler *s = query_scheduler::current())
+                    s->root_done();
+                return std::noop_coroutine();
+            }
+
+            void await_resume() noexcept
+            {
+            }
+        };
+
+        final_awaiter final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_value(T v)
+        {
+            value = std::move(v);
+        }
+
+        void unhandled_exception()
+        {
+            error = std::current_exception();
+        }
+    };
+
+private:
+    std::coroutine_handle<promise_type> coro;
+
+    explicit query_task(std::coroutine_handle<promise_type> h) : coro(h)
+    {
+    }
+
+public:
+    query_task(query_task &&other) noexcept : coro(std::exchange(other.coro, nullptr))
+    {
+    }
+
+    query_task &operator=(query_task &&other) noexcept
+    {
+        if (this != &other) {
+            if (coro)
+                coro.destroy();
+            coro = std::exchange(other.coro, nullptr);
+        }
+        return *this;
+    }
+
+    query_task(const query_task &) = delete;
+    query_task &operator=(const query_task &) = delete;
+
+    ~query_task()
+    {
+        if (coro)
+            coro.destroy();
+    }
+
+    std::coroutine_handle<> handle() const
+    {
+        return coro;
+    }
+
+    bool done() const
+    {
+        return coro.done();
+    }
+
+    // Result of a finished task; runs it here first if it has not run
+    T get()
+    {
+        if (!coro.done())
+            coro.resume();
+        if (coro.promise().error)
+            std::rethrow_exception(coro.promise().error);
+        return *coro.promise().value;
+    }
+
+    // co_await from another task: start this one, resume the caller at the end
+    auto operator co_await() noexcept
+    {
+        struct awaiter {
+            std::coroutine_handle<promise_type> coro;
+
+            bool await_ready() noexcept
+            {
+                return coro.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+            {
+                coro.promise().continuation = caller;
+                return coro;
+            }
+
+            T await_resume()
+            {
+                if (coro.promise().error)
+                    std::rethrow_exception(coro.promise().error);
+                return *coro.promise().value;
+            }
+        };
+        return awaiter{coro};
+    }
+};
+
+#endif
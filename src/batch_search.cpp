@@ -0,0 +1,101 @@
+/** Interleaved binary searches over a suffix array.
+ *
+ * A single search is a chain of dependent misses: SA[mi], then the suffix
+ * at t[SA[mi]]. batch_interval runs up to `group` searches for different
+ * patterns in lockstep. Each visit to a search advances it by one stage
+ * and prefetches what its next stage needs, then moves to the next search,
+ * so the misses of all searches in the group are in flight together.
+ *
+ * Stages per binary search step:
+ *  - load: read SA[mi] (prefetched), prefetch the suffix bytes,
+ *  - compare: compare the suffix with the pattern, move lo/hi, pick the
+ *    next mi and prefetch SA[mi]. */
+
+#ifndef BATCH_SEARCH
+#define BATCH_SEARCH
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+template <class Patterns>
+void batch_interval(std::string_view t, std::span<const std::int64_t> SA, const Patterns &patterns,
+                    std::span<std::pair<std::int64_t, std::int64_t>> ranges, std::int64_t group = 16)
+{
+    struct lane {
+        std::int64_t pattern = -1;
+        std::string_view s;
+        bool upper = false; // Searching the upper bound
+        bool loaded = false; // SA[mi] read, suffix prefetched
+        std::int64_t lo, hi, mi, suffix, first;
+    };
+
+    std::int64_t n = t.length();
+    std::int64_t total = patterns.size();
+    std::int64_t next = 0, done = 0;
+    std::vector<lane> lanes(std::max<std::int64_t>(1, std::min(group, total)));
+
+    // Starts the next pattern on a lane, or leaves it idle
+    auto start = [&](lane &l) {
+        l.pattern = -1;
+        while (next < total) {
+            std::int64_t p = next++;
+            std::string_view s = patterns[p];
+            if (s.length() > t.length()) {
+                ranges[p] = {0, 0};
+                done++;
+                continue;
+            }
+            l = {p, s, false, false, 0, n, n / 2, 0, 0};
+            __builtin_prefetch(&SA[l.mi]);
+            return;
+        }
+    };
+
+    for (auto &l : lanes)
+        start(l);
+
+    while (done < total) {
+        for (auto &l : lanes) {
+            if (l.pattern < 0)
+                continue;
+
+            if (!l.loaded) {
+                l.suffix = SA[l.mi];
+                __builtin_prefetch(t.data() + l.suffix);
+                l.loaded = true;
+                continue;
+            }
+
+            // Same tests as suffix_array::interval
+            std::string_view suffix = t.substr(l.suffix);
+            bool right = l.upper ? suffix.starts_with(l.s) : suffix < l.s;
+            if (right)
+                l.lo = l.mi + 1;
+            else
+                l.hi = l.mi;
+
+            if (l.lo >= l.hi && !l.upper) {
+                // Lower bound found; the upper bound search starts from it
+                l.first = l.lo;
+                l.hi = n;
+                l.upper = true;
+            }
+            if (l.lo >= l.hi) {
+                ranges[l.pattern] = {l.first, l.hi};
+                done++;
+                start(l);
+                continue;
+            }
+
+            l.mi = l.lo + (l.hi - l.lo) / 2;
+            __builtin_prefetch(&SA[l.mi]);
+            l.loaded = false;
+        }
+    }
+}
+
+#endif
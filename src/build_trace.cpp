@@ -0,0 +1,180 @@
+/** Tracing hooks for index construction.
+ *
+ * Construction code marks its phases with trace_scope (begin/end events)
+ * and reports values with trace_instant, e.g. the distinct ranks after
+ * every doubling round. Events go to the tracer installed on the calling
+ * thread by a trace_session; without one, every hook is a single
+ * thread_local load, so builds pay nothing when nobody is listening.
+ *
+ * A tracer is any callback taking a trace_event. chrome_trace writes them
+ * as Chrome trace JSON, to be opened in chrome://tracing or Perfetto.
+ *
+ * Only the thread that installed the tracer reports: phases are traced
+ * around parallel sections, not from inside their workers.
+ *
+ * Events:
+ *  - bucket_sort, doubling_round, divsufsort: SA construction,
+ *    with distinct_ranks after each round and ranks_unique when the
+ *    ranks become a permutation,
+ *  - lcp, bwt (bwt_bucket when blockwise), occurrence_tables: the other
+ *    steps,
+ *  - sdsl_construct: an sdsl index built by construct_im, which runs
+ *    the SA, BWT and wavelet tree steps in one call, so they are not
+ *    told apart. */
+
+#ifndef BUILD_TRACE
+#define BUILD_TRACE
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <ostream>
+#include <span>
+#include <utility>
+
+struct trace_arg {
+    const char *name;
+    std::int64_t value;
+};
+
+struct trace_event {
+    const char *name;
+    char phase;                     // 'B' begin, 'E' end, 'i' instant
+    std::int64_t time;              // Nanoseconds since the session started
+    std::span<const trace_arg> args;
+};
+
+using build_tracer = std::function<void(const trace_event &)>;
+
+namespace build_trace {
+
+struct session_state {
+    build_tracer tracer;
+    std::chrono::steady_clock::time_point start;
+};
+
+inline thread_local session_state *current = nullptr;
+
+inline void emit(const char *name, char phase, std::span<const trace_arg> args)
+{
+    std::int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - current->start)
+                            .count();
+    current->tracer(trace_event{name, phase, time, args});
+}
+
+} // namespace build_trace
+
+// Installs tracer on this thread for the session's lifetime; sessions
+// nest, and the previous tracer is restored on exit
+class trace_session
+{
+private:
+    build_trace::session_state state;
+    build_trace::session_state *previous;
+
+public:
+    explicit trace_session(build_tracer tracer)
+        : state{std::move(tracer), std::chrono::steady_clock::now()}, previous(build_trace::current)
+    {
+        build_trace::current = &state;
+    }
+
+    trace_session(const trace_session &) = delete;
+    trace_session &operator=(const trace_session &) = delete;
+
+    ~trace_session()
+    {
+        build_trace::current = previous;
+    }
+};
+
+inline bool tracing()
+{
+    return build_trace::current != nullptr;
+}
+
+inline void trace_instant(const char *name, std::initializer_list<trace_arg> args = {})
+{
+    if (build_trace::current)
+        build_trace::emit(name, 'i', std::span<const trace_arg>(args.begin(), args.size()));
+}
+
+// Begin event now, end event when the scope closes
+class trace_scope
+{
+private:
+    const char *name;
+    bool active;
+
+public:
+    explicit trace_scope(const char *name, std::initializer_list<trace_arg> args = {})
+        : name(name), active(build_trace::current != nullptr)
+    {
+        if (active)
+            build_trace::emit(name, 'B', std::span<const trace_arg>(args.begin(), args.size()));
+    }
+
+    trace_scope(const trace_scope &) = delete;
+    trace_scope &operator=(const trace_scope &) = delete;
+
+    ~trace_scope()
+    {
+        // The session may have ended inside the scope
+        if (active && build_trace::current)
+            build_trace::emit(name, 'E', {});
+    }
+};
+
+// Writes events as a Chrome trace JSON object; the file is complete once
+// the writer is destroyed
+class chrome_trace
+{
+private:
+    std::ostream &out;
+    bool first = true;
+
+public:
+    explicit chrome_trace(std::ostream &out) : out(out)
+    {
+        out << "{\"traceEvents\":[\n";
+    }
+
+    chrome_trace(const chrome_trace &) = delete;
+    chrome_trace &operator=(const chrome_trace &) = delete;
+
+    ~chrome_trace()
+    {
+        out << "\n]}\n";
+        out.flush();
+    }
+
+    void operator()(const trace_event &event)
+    {
+        if (!first)
+            out << ",\n";
+        first = false;
+        // Timestamps are in microseconds
+        out << "{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.time / 1000
+            << '.' << (event.time % 1000) / 100 << (event.time % 100) / 10 << event.time % 10
+            << ",\"pid\":1,\"tid\":1";
+        if (event.phase == 'i')
+            out << ",\"s\":\"t\"";
+        if (!event.args.empty()) {
+            out << ",\"args\":{";
+            for (std::size_t i = 0; i < event.args.size(); i++)
+                out << (i ? "," : "") << '"' << event.args[i].name << "\":" << event.args[i].value;
+            out << '}';
+        }
+        out << '}';
+    }
+
+    // Callback to install with a trace_session
+    build_tracer tracer()
+    {
+        return [this](const trace_event &event) { (*this)(event); };
+    }
+};
+
+#endif
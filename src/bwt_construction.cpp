@@ -0,0 +1,156 @@
+/** Suffix order without the suffix array, for BWT construction.
+ *
+ * for_each_suffix_blockwise calls fn(row, position) for every suffix of t
+ * in SA order, holding only one bucket of positions at a time:
+ *  1. suffixes are classified by their first k symbols, k as large as
+ *     fits 2^20 prefix counters for the text's alphabet,
+ *  2. consecutive prefixes are grouped into buckets of at most
+ *     memory_budget bytes of positions (a single prefix may exceed it),
+ *  3. each bucket is collected in one scan of t, sorted by prefix and then
+ *     by comparing the suffixes, and handed to fn in order.
+ * Working memory is the bucket plus the prefix counters, instead of the
+ * 8n bytes of a full SA, at the cost of one pass over t per bucket.
+ *
+ * Comparisons cost the length of the common prefix, except inside runs of
+ * one character of length >= 32 (e.g. the N blocks of a genome), which are
+ * skipped in one step. Texts with very long non-run repeats sort slowly.
+ * t must end with a unique minimal ETX, as for build_sa. */
+
+#ifndef BWT_CONSTRUCTION
+#define BWT_CONSTRUCTION
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "build_trace.cpp"
+#include "construction_arena.cpp"
+
+template <class Fn>
+void for_each_suffix_blockwise(std::string_view t, std::int64_t memory_budget, construction_arena &arena, Fn &&fn)
+{
+    arena_scope scope(arena);
+    std::int64_t n = t.length();
+    std::int64_t i, j;
+
+    // Prefix codes over the effective alphabet keep the counters small
+    std::array<std::int64_t, 256> code{};
+    std::array<bool, 256> present{};
+    for (i = 0; i < n; i++)
+        present[static_cast<unsigned char>(t[i])] = true;
+    std::int64_t sigma = 0;
+    for (i = 0; i < 256; i++)
+        if (present[i])
+            code[i] = sigma++;
+
+    std::int64_t k = 1, codes = sigma;
+    while (k < 8 && codes * sigma <= (std::int64_t(1) << 20)) {
+        codes *= sigma;
+        k++;
+    }
+
+    // Rolling prefix code of every suffix; positions past the end read
+    // as symbol 0, which is the ETX
+    auto for_each_prefix = [&](auto &&visit) {
+        std::int64_t prefix = 0, top = codes / sigma;
+        for (std::int64_t q = 0; q < k; q++)
+            prefix = prefix * sigma + (q < n ? code[static_cast<unsigned char>(t[q])] : 0);
+        for (std::int64_t p = 0; p < n; p++) {
+            visit(p, prefix);
+            std::int64_t next = p + k < n ? code[static_cast<unsigned char>(t[p + k])] : 0;
+            prefix = (prefix - top * code[static_cast<unsigned char>(t[p])]) * sigma + next;
+        }
+    };
+
+    std::vector<std::int64_t> counts(codes, 0);
+    for_each_prefix([&](std::int64_t, std::int64_t prefix) { counts[prefix]++; });
+
+    // Runs of one character long enough to be worth skipping
+    const std::int64_t min_run = 32;
+    std::vector<std::pair<std::int64_t, std::int64_t>> runs;
+    for (i = 0; i < n; i = j) {
+        for (j = i + 1; j < n && t[j] == t[i]; j++)
+            ;
+        if (j - i >= min_run)
+            runs.emplace_back(i, j);
+    }
+
+    // End of the run holding p, or p itself when it is in no long run
+    auto run_end = [&](std::int64_t p) {
+        auto it = std::upper_bound(runs.begin(), runs.end(), std::make_pair(p, n));
+        if (it == runs.begin() || (--it)->second <= p)
+            return p;
+        return it->second;
+    };
+
+    auto suffix_less = [&](std::int64_t a, std::int64_t b) {
+        // Irreflexive, as std::sort requires
+        if (a == b)
+            return false;
+        // Both suffixes share the first k symbols
+        a += k;
+        b += k;
+        while (a < n && b < n) {
+            std::int64_t length = std::min<std::int64_t>({32, n - a, n - b});
+            int res = std::memcmp(t.data() + a, t.data() + b, length);
+            if (res != 0) {
+                for (; t[a] == t[b]; a++, b++)
+                    ;
+                return static_cast<unsigned char>(t[a]) < static_cast<unsigned char>(t[b]);
+            }
+            a += length;
+            b += length;
+            // Equal so far: jump over a common run in one step
+            if (a < n && b < n && t[a] == t[b]) {
+                std::int64_t skip = std::min(run_end(a) - a, run_end(b) - b);
+                a += skip;
+                b += skip;
+            }
+        }
+        // The ETX is unique, so this is reached only through it
+        return a >= n;
+    };
+
+    std::int64_t budget_rows = std::max<std::int64_t>(1, memory_budget / sizeof(std::uint64_t));
+    std::int64_t largest = std::max(budget_rows, *std::max_element(counts.begin(), counts.end()));
+    auto bucket = arena.allocate<std::uint64_t>(largest);
+
+    // Keys pack (prefix, position); prefixes fit 20 bits
+    std::int64_t row = 0;
+    for (std::int64_t lo = 0, hi; lo < codes; lo = hi) {
+        std::int64_t size = counts[lo];
+        for (hi = lo + 1; hi < codes && size + counts[hi] <= budget_rows; hi++)
+            size += counts[hi];
+        if (size == 0)
+            continue;
+        trace_scope phase("bwt_bucket", {{"rows", size}});
+
+        std::int64_t filled = 0;
+        for_each_prefix([&](std::int64_t p, std::int64_t prefix) {
+            if (prefix >= lo && prefix < hi)
+                bucket[filled++] = (std::uint64_t(prefix) << 44) | std::uint64_t(p);
+        });
+
+        std::span<std::uint64_t> keys = bucket.first(size);
+        std::sort(keys.begin(), keys.end());
+
+        const std::uint64_t position = (std::uint64_t(1) << 44) - 1;
+        for (std::int64_t s = 0, e; s < size; s = e) {
+            for (e = s + 1; e < size && (keys[e] >> 44) == (keys[s] >> 44); e++)
+                ;
+            if (e - s > 1)
+                std::sort(keys.begin() + s, keys.begin() + e, [&](std::uint64_t x, std::uint64_t y) {
+                    return suffix_less(x & position, y & position);
+                });
+            for (std::int64_t r = s; r < e; r++)
+                fn(row++, static_cast<std::int64_t>(keys[r] & position));
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,356 @@
+/** FM-index over bytes without a wavelet tree.
+ *
+ * rank(c, i) over the BWT is answered from a two-level occurrence table:
+ *  - superblocks of 2^16 rows: 64-bit counts of every symbol before them,
+ *  - blocks of 128 rows: 16-bit counts since the superblock start,
+ * plus a compare of the 128-byte BWT block (two cache lines, AVX2/AVX-512
+ * when built with them, SWAR otherwise) for the rest. A backward search
+ * step then costs about two cache misses whatever the alphabet size,
+ * instead of one rank per wavelet tree level.
+ *
+ * The BWT uses the effective alphabet (symbols that occur, remapped to
+ * 0..sigma-1), so the table has sigma columns rather than 256. Space is
+ * n bytes of BWT plus 2 sigma / 128 bytes per row for the blocks, e.g.
+ * about 2.5n for source code (sigma ~ 100) and 1.06n for DNA.
+ *
+ * t_dens: SA sample density, t_inv_dens: ISA sample density, as in fmindex.
+ * The index is self-contained: the text is not kept. */
+
+#ifndef BYTE_FMINDEX
+#define BYTE_FMINDEX
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#if defined(__AVX2__) || defined(__AVX512BW__)
+#include <immintrin.h>
+#endif
+
+#include "bwt_construction.cpp"
+#include "construction_arena.cpp"
+#include "lcp_encoding.cpp"
+#include "parallel.cpp"
+#include "sa_construction.cpp"
+
+// Selects the blockwise construction, see bwt_construction.cpp
+struct blockwise_bwt {
+    std::int64_t memory_budget = 0; // Bytes per bucket of positions, 0: n
+};
+
+template <std::uint32_t t_dens = 32, std::uint32_t t_inv_dens = 64>
+class byte_fmindex
+{
+private:
+    static constexpr std::int64_t block_size = 128;
+    static constexpr std::int64_t super_size = std::int64_t(1) << 16;
+
+    std::int64_t n = 0;
+    std::int64_t sigma = 0;
+    std::array<std::int16_t, 256> code;     // Byte to symbol, -1 if absent
+    std::array<std::uint8_t, 256> symbols;  // Symbol to byte
+    std::vector<std::int64_t> C;            // Rows starting with a smaller symbol
+    std::vector<std::uint8_t> bwt;          // In symbols
+    std::vector<std::uint64_t> supers;      // sigma counts per superblock
+    std::vector<std::uint16_t> blocks;      // sigma counts per block
+    lcp_bits sampled;                       // Rows whose SA value is sampled
+    std::vector<std::int64_t> sa_samples;   // SA values of the sampled rows
+    std::vector<std::int64_t> isa_samples;  // Row of text position k * t_inv_dens
+
+    // Superblocks are independent once their starting counts are known, so
+    // both passes run one superblock range per thread
+    void build_tables(std::int64_t threads)
+    {
+        trace_scope phase("occurrence_tables");
+        std::int64_t s, c, supers_count = n / super_size + 1;
+        supers.assign(supers_count * sigma, 0);
+        blocks.assign((n / block_size + 1) * sigma, 0);
+
+        // Histogram of each full superblock, stored in the next row
+        parallel_chunks(supers_count - 1, threads, [&](std::int64_t lo, std::int64_t hi) {
+            for (std::int64_t s = lo; s < hi; s++) {
+                std::uint64_t *next = supers.data() + (s + 1) * sigma;
+                for (std::int64_t i = s * super_size; i < (s + 1) * super_size; i++)
+                    next[bwt[i]]++;
+            }
+        });
+        for (s = 1; s < supers_count; s++)
+            for (c = 0; c < sigma; c++)
+                supers[s * sigma + c] += supers[(s - 1) * sigma + c];
+
+        // Block rows, counting from each superblock start
+        parallel_chunks(supers_count, threads, [&](std::int64_t lo, std::int64_t hi) {
+            std::vector<std::uint16_t> running(sigma);
+            for (std::int64_t s = lo; s < hi; s++) {
+                std::fill(running.begin(), running.end(), 0);
+                std::int64_t end = std::min(n + 1, (s + 1) * super_size);
+                for (std::int64_t i = s * super_size; i < end; i++) {
+                    if (i % block_size == 0)
+                        std::copy(running.begin(), running.end(), blocks.begin() + (i / block_size) * sigma);
+                    if (i < n)
+                        running[bwt[i]]++;
+                }
+            }
+        });
+    }
+
+    // Effective alphabet and C, from per-thread symbol counts
+    void init_alphabet(std::string_view t, std::int64_t threads)
+    {
+        std::int64_t c;
+        std::vector<std::array<std::int64_t, 256>> partial(std::max<std::int64_t>(1, threads));
+        parallel_chunks(partial.size(), partial.size(), [&](std::int64_t lo, std::int64_t hi) {
+            for (std::int64_t part = lo; part < hi; part++) {
+                auto &freq = partial[part];
+                freq.fill(0);
+                std::int64_t end = n * (part + 1) / partial.size();
+                for (std::int64_t i = n * part / partial.size(); i < end; i++)
+                    freq[static_cast<unsigned char>(t[i])]++;
+            }
+        });
+        std::array<std::int64_t, 256> freq{};
+        for (const auto &counts : partial)
+            for (c = 0; c < 256; c++)
+                freq[c] += counts[c];
+
+        code.fill(-1);
+        C.clear();
+        for (c = 0; c < 256; c++) {
+            if (freq[c] == 0)
+                continue;
+            code[c] = sigma;
+            symbols[sigma] = c;
+            C.push_back(sigma == 0 ? 0 : C.back() + freq[symbols[sigma - 1]]);
+            sigma++;
+        }
+        C.push_back(n);
+    }
+
+#if defined(__AVX2__) || defined(__AVX512BW__)
+    // Bit j of the result is set when p[j] == c, for j < 64
+    static std::uint64_t match_mask(const std::uint8_t *p, std::uint8_t c)
+    {
+#if defined(__AVX512BW__)
+        return _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(p), _mm512_set1_epi8(c));
+#else
+        __m256i pattern = _mm256_set1_epi8(c);
+        std::uint32_t lo = _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), pattern));
+        std::uint32_t hi = _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32)), pattern));
+        return (std::uint64_t(hi) << 32) | lo;
+#endif
+    }
+#endif
+
+    // Occurrences of c in p[0, length), length < block_size. The whole
+    // block is compared and the tail masked off, so nothing branches on
+    // length
+    static std::int64_t block_rank(const std::uint8_t *p, std::uint8_t c, std::int64_t length)
+    {
+        static_assert(block_size == 128);
+#if defined(__AVX2__) || defined(__AVX512BW__)
+        std::int64_t first = std::min<std::int64_t>(length, 64), second = length - first;
+        std::uint64_t keep_first = first == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << first) - 1;
+        std::uint64_t keep_second = (std::uint64_t(1) << second) - 1;
+        return std::popcount(match_mask(p, c) & keep_first) + std::popcount(match_mask(p + 64, c) & keep_second);
+#else
+        // 8 bytes at a time: after the xor matching bytes are zero, and
+        // zero bytes get their high bit set
+        const std::uint64_t ones = 0x0101010101010101, low7 = 0x7F7F7F7F7F7F7F7F;
+        std::int64_t count = 0;
+        for (std::int64_t j = 0; j < block_size; j += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, p + j, 8);
+            word ^= ones * c;
+            std::uint64_t zero = ~(((word & low7) + low7) | word | low7);
+            std::int64_t valid = std::clamp<std::int64_t>(length - j, 0, 8);
+            std::uint64_t keep = valid == 8 ? ~std::uint64_t(0) : (std::uint64_t(1) << (8 * valid)) - 1;
+            count += std::popcount(zero & keep);
+        }
+        return count;
+#endif
+    }
+
+    // Occurrences of symbol c in bwt[0, i)
+    std::int64_t rank(std::uint8_t c, std::int64_t i) const
+    {
+        std::int64_t count = supers[(i / super_size) * sigma + c] + blocks[(i / block_size) * sigma + c];
+        const std::uint8_t *p = bwt.data() + i / block_size * block_size;
+        return count + block_rank(p, c, i % block_size);
+    }
+
+    // Row of the suffix one position before the suffix at row i
+    std::int64_t LF(std::int64_t i) const
+    {
+        std::uint8_t c = bwt[i];
+        return C[c] + rank(c, i);
+    }
+
+public:
+    // text is taken by value and released once the index is built
+    // threads: used by the SA (packed_doubling), the BWT and the tables
+    byte_fmindex(std::string text, sa_construction method = sa_construction::packed_doubling,
+                 std::int64_t threads = default_threads(), construction_arena *arena = nullptr)
+    {
+        char ETX = 3;
+        text += ETX;
+        std::string_view t = text;
+        n = t.length();
+
+        construction_arena local;
+        construction_arena &scratch = arena ? *arena : local;
+        arena_scope scope(scratch);
+
+        auto SA = scratch.allocate<std::int64_t>(n);
+        build_sa(t, SA, method, &scratch, threads);
+
+        init_alphabet(t, threads);
+
+        // BWT and samples, in chunks of 64 rows so no two threads share a
+        // word of sampled
+        {
+            trace_scope phase("bwt");
+            bwt.resize(n + block_size); // Padding for the block scan in rank
+            sampled.resize(n);
+            isa_samples.assign((n + t_inv_dens - 1) / t_inv_dens, 0);
+            parallel_chunks((n + 63) / 64, threads, [&](std::int64_t lo, std::int64_t hi) {
+                for (std::int64_t i = lo * 64; i < std::min(n, hi * 64); i++) {
+                    std::int64_t previous = SA[i] == 0 ? n - 1 : SA[i] - 1;
+                    bwt[i] = code[static_cast<unsigned char>(t[previous])];
+                    if (SA[i] % t_dens == 0)
+                        sampled.set(i);
+                    if (SA[i] % t_inv_dens == 0)
+                        isa_samples[SA[i] / t_inv_dens] = i;
+                }
+            });
+            sampled.init_support();
+            sa_samples.resize(sampled.rank1(n));
+            parallel_chunks(n, threads, [&](std::int64_t lo, std::int64_t hi) {
+                std::int64_t k = sampled.rank1(lo);
+                for (std::int64_t i = lo; i < hi; i++)
+                    if (SA[i] % t_dens == 0)
+                        sa_samples[k++] = SA[i];
+            });
+        }
+
+        build_tables(threads);
+    }
+
+    // Same index without the 8n-byte SA: rows are produced bucket by bucket
+    // (bwt_construction.cpp), in SA order, and consumed as they arrive.
+    // memory_budget bounds each bucket, n bytes when 0, so construction
+    // peaks at about the text plus the final index
+    byte_fmindex(std::string text, blockwise_bwt options, construction_arena *arena = nullptr)
+    {
+        char ETX = 3;
+        text += ETX;
+        std::string_view t = text;
+        n = t.length();
+
+        construction_arena local;
+        construction_arena &scratch = arena ? *arena : local;
+
+        init_alphabet(t, 1);
+
+        {
+            trace_scope phase("bwt");
+            bwt.resize(n + block_size); // Padding for the block scan in rank
+            sampled.resize(n);
+            isa_samples.assign((n + t_inv_dens - 1) / t_inv_dens, 0);
+            sa_samples.reserve(n / t_dens + 1);
+            std::int64_t budget = options.memory_budget > 0 ? options.memory_budget : n;
+            for_each_suffix_blockwise(t, budget, scratch, [&](std::int64_t i, std::int64_t position) {
+                std::int64_t previous = position == 0 ? n - 1 : position - 1;
+                bwt[i] = code[static_cast<unsigned char>(t[previous])];
+                if (position % t_dens == 0) {
+                    sampled.set(i);
+                    sa_samples.push_back(position);
+                }
+                if (position % t_inv_dens == 0)
+                    isa_samples[position / t_inv_dens] = i;
+            });
+            sampled.init_support();
+        }
+
+        build_tables(1);
+    }
+
+    // SA range [first, last) of the suffixes starting with s
+    std::pair<std::int64_t, std::int64_t> interval(const std::string_view s) const
+    {
+        std::int64_t sp = 0, ep = n;
+        for (std::int64_t k = s.length() - 1; k >= 0 && sp < ep; k--) {
+            std::int16_t c = code[static_cast<unsigned char>(s[k])];
+            if (c < 0)
+                return {0, 0};
+            sp = C[c] + rank(c, sp);
+            ep = C[c] + rank(c, ep);
+        }
+        return sp < ep ? std::pair<std::int64_t, std::int64_t>{sp, ep} : std::pair<std::int64_t, std::int64_t>{0, 0};
+    }
+
+    std::int64_t count(const std::string_view s) const
+    {
+        auto [first, last] = interval(s);
+        return last - first;
+    }
+
+    // SA value at row i, by LF steps to the closest sampled row
+    std::int64_t operator[](std::int64_t i) const
+    {
+        std::int64_t steps = 0;
+        while (!sampled[i]) {
+            i = LF(i);
+            steps++;
+        }
+        return (sa_samples[sampled.rank1(i)] + steps) % n;
+    }
+
+    // Text positions of the occurrences of s, in SA order
+    std::vector<std::int64_t> locate(const std::string_view s) const
+    {
+        auto [first, last] = interval(s);
+        std::vector<std::int64_t> positions;
+        positions.reserve(last - first);
+        for (std::int64_t i = first; i < last; i++)
+            positions.push_back((*this)[i]);
+        return positions;
+    }
+
+    // Text in [begin, end], walking back from the next ISA sample
+    std::string extract(std::size_t begin, std::size_t end) const
+    {
+        std::int64_t b = begin, e = std::min<std::int64_t>(end, n - 2);
+        if (b > e)
+            return "";
+
+        // Row of text position p; position n wraps to 0
+        std::int64_t p = std::min((e / t_inv_dens + 1) * t_inv_dens, n);
+        std::int64_t row = isa_samples[(p % n) / t_inv_dens];
+
+        std::string out(e - b + 1, '\0');
+        for (; p > b; p--) {
+            // bwt[row] is the character at position p - 1
+            if (p - 1 <= e)
+                out[p - 1 - b] = symbols[bwt[row]];
+            row = LF(row);
+        }
+        return out;
+    }
+
+    std::int64_t size_in_bytes() const
+    {
+        return n + sizeof(std::uint64_t) * supers.size() + sizeof(std::uint16_t) * blocks.size()
+               + sizeof(std::int64_t) * (C.size() + sa_samples.size() + isa_samples.size())
+               + sampled.memory_usage() + sizeof(code) + sizeof(symbols);
+    }
+};
+
+#endif
@@ -0,0 +1,136 @@
+/** Reusable scratch memory for index construction.
+ *
+ * Builders take their temporaries from the arena as uninitialized spans,
+ * bump-allocated inside large blocks, and give them back in LIFO order
+ * through arena_scope. The blocks stay allocated, so a process building
+ * many indexes does not pay page faults and zeroing on every build. When
+ * a build outgrows the first block, the blocks are merged into one as
+ * soon as the arena is empty again. */
+
+#ifndef CONSTRUCTION_ARENA
+#define CONSTRUCTION_ARENA
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+class construction_arena
+{
+private:
+    static constexpr std::size_t alignment = 64; // Cache line
+    static constexpr std::size_t min_block = std::size_t(1) << 20;
+
+    struct block {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    std::vector<block> blocks;
+    std::size_t current = 0; // Block being bumped
+    std::size_t offset = 0;  // Bytes used in it
+
+    static std::size_t align_up(std::size_t x)
+    {
+        return (x + alignment - 1) / alignment * alignment;
+    }
+
+    void add_block(std::size_t size)
+    {
+        // new[] on std::byte leaves the memory uninitialized
+        blocks.push_back({std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+    }
+
+public:
+    struct mark {
+        std::size_t block, offset;
+    };
+
+    construction_arena() = default;
+
+    // Reserve room for a build up front
+    construction_arena(std::size_t bytes)
+    {
+        if (bytes > 0)
+            add_block(align_up(bytes));
+    }
+
+    construction_arena(const construction_arena &) = delete;
+    construction_arena &operator=(const construction_arena &) = delete;
+
+    // Uninitialized storage for n values of T
+    template <class T>
+    std::span<T> allocate(std::size_t n)
+    {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>);
+        std::size_t bytes = align_up(n * sizeof(T));
+
+        // Blocks after the current one are free
+        for (; current < blocks.size(); current++, offset = 0) {
+            if (offset + bytes <= blocks[current].size) {
+                T *p = reinterpret_cast<T *>(blocks[current].data.get() + offset);
+                offset += bytes;
+                return {p, n};
+            }
+        }
+
+        // Sized to the request: the merge on release makes the next build
+        // fit in a single block, so growing geometrically would only
+        // raise the peak of the first build
+        add_block(std::max(bytes, min_block));
+        current = blocks.size() - 1;
+        offset = bytes;
+        return {reinterpret_cast<T *>(blocks[current].data.get()), n};
+    }
+
+    mark position() const
+    {
+        return {current, offset};
+    }
+
+    // Frees everything allocated after m
+    void release(mark m)
+    {
+        current = m.block;
+        offset = m.offset;
+
+        if (current == 0 && offset == 0 && blocks.size() > 1) {
+            std::size_t total = capacity();
+            blocks.clear();
+            add_block(total);
+        }
+    }
+
+    std::size_t capacity() const
+    {
+        std::size_t total = 0;
+        for (const auto &b : blocks)
+            total += b.size;
+        return total;
+    }
+};
+
+// Gives back whatever was allocated from the arena during its lifetime
+class arena_scope
+{
+private:
+    construction_arena &arena;
+    construction_arena::mark start;
+
+public:
+    arena_scope(construction_arena &a) : arena(a), start(a.position())
+    {
+    }
+
+    ~arena_scope()
+    {
+        arena.release(start);
+    }
+
+    arena_scope(const arena_scope &) = delete;
+    arena_scope &operator=(const arena_scope &) = delete;
+};
+
+#endif
@@ -0,0 +1,82 @@
+/** Append-capable index made of static suffix_array segments.
+ *
+ * Each append builds a small segment over the new text only. Segments are
+ * kept with geometrically decreasing sizes and the trailing ones are merged
+ * whenever they get too close in size (logarithmic method), so every
+ * character is re-indexed O(lg n) times overall instead of on each append.
+ * Queries fan out to all segments and add up the results.
+ *
+ * Appended texts are treated as separate documents: they are joined with
+ * ETX, so occurrences spanning two appends are not reported and patterns
+ * must not contain ETX. */
+
+#ifndef DYNAMIC_SUFFIX_ARRAY
+#define DYNAMIC_SUFFIX_ARRAY
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "suffix_array.cpp"
+
+class dynamic_suffix_array
+{
+private:
+    // Largest segment first; suffix_array holds a view into its own
+    // text, so segments are kept behind pointers and never moved
+    std::vector<std::unique_ptr<suffix_array>> segments;
+
+public:
+    dynamic_suffix_array() = default;
+
+    // text is taken by value, see suffix_array
+    dynamic_suffix_array(std::string text)
+    {
+        append(std::move(text));
+    }
+
+    void append(std::string text)
+    {
+        const char ETX = 3;
+        std::string pending = std::move(text);
+
+        // Absorb every trailing segment that is not at least twice as large
+        // as what is being built, so sizes keep halving along the list
+        while (!segments.empty() &&
+               segments.back()->text().length() <= 2 * pending.length()) {
+            std::string merged(segments.back()->text());
+            merged += ETX;
+            merged += pending;
+            pending = std::move(merged);
+            segments.pop_back();
+        }
+
+        segments.push_back(std::make_unique<suffix_array>(std::move(pending)));
+    }
+
+    std::int64_t count(const std::string_view s) const
+    {
+        std::int64_t matches = 0;
+        for (const auto &segment : segments)
+            matches += segment->count(s);
+        return matches;
+    }
+
+    std::int64_t segment_count() const
+    {
+        return segments.size();
+    }
+
+    std::int64_t size_in_bytes() const
+    {
+        std::int64_t total_memory = 0;
+        for (const auto &segment : segments)
+            total_memory += segment->size_in_bytes();
+        return total_memory;
+    }
+};
+
+#endif
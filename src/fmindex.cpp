@@ -1,12 +1,22 @@
 #ifndef FMINDEX
 #define FMINDEX
 
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <sdsl/suffix_arrays.hpp>
 #include <sdsl/util.hpp>
 
+#include "build_trace.cpp"
+
+// t_dens: SA sample density, t_inv_dens: ISA sample density.
+// Sparser samples shrink the index but make locate/extract slower.
+template <class t_wt = sdsl::wt_huff<sdsl::rrr_vector<127> >,
+          std::uint32_t t_dens = 512, std::uint32_t t_inv_dens = 1024>
 class fmindex {
 private:
-    sdsl::csa_wt<sdsl::wt_huff<sdsl::rrr_vector<127> >, 512, 1024> fm_index;
+    sdsl::csa_wt<t_wt, t_dens, t_inv_dens> fm_index;
     std::string t;
     std::string _t;
 public:
@@ -14,19 +24,38 @@ public:
         char ETX = 3;
         _t = text + ETX;
         t = _t;
+        // construct_im hace SA, BWT y wavelet tree en una sola llamada
+        trace_scope phase("sdsl_construct");
         sdsl::construct_im(fm_index, t, 1);
     }
 
     // Contar ocurrencias de un patrón
-    size_t count(const std::string& pattern) const {
-        size_t occs = sdsl::count(fm_index, pattern.begin(), pattern.end());
+    std::int64_t count(std::string_view pattern) const {
+        return sdsl::count(fm_index, pattern.begin(), pattern.end());
+    }
+
+    // Rango [first, last) del patrón en el arreglo de sufijos
+    std::pair<size_t, size_t> interval(std::string_view pattern) const {
+        size_t sp = 0, ep = 0;
+        size_t occs = sdsl::backward_search(fm_index, 0, fm_index.size() - 1, pattern.begin(), pattern.end(), sp, ep);
+        return {sp, sp + occs};
+    }
+
+    // Posiciones de las ocurrencias de un patrón
+    sdsl::int_vector<64> locate(std::string_view pattern) const {
+        return sdsl::locate(fm_index, pattern.begin(), pattern.end());
+    }
+
+    // Extraer el texto en [begin, end]
+    std::string extract(size_t begin, size_t end) const {
+        return sdsl::extract(fm_index, begin, end);
     }
 
     // Obtener el tamaño en bytes de la estructura
-    size_t size_in_bytes() const {
+    std::int64_t size_in_bytes() const {
         return sdsl::size_in_bytes(fm_index);
     }
 
 };
 
-#endif
\ No newline at end of file
+#endif
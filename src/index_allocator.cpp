@@ -0,0 +1,178 @@
+/** Allocator for large index arrays with huge page and NUMA placement.
+ *
+ * With the default policy it behaves like std::allocator. Otherwise arrays
+ * are mapped with mmap, rounded up to 2 MiB, and:
+ *  - transparent_huge: madvise(MADV_HUGEPAGE) so THP backs the mapping,
+ *  - explicit_huge: MAP_HUGETLB 2 MiB pages from the hugetlbfs pool,
+ *    falling back to transparent_huge when the pool is exhausted,
+ *  - interleave: pages spread round-robin over the online NUMA nodes
+ *    (mbind MPOL_INTERLEAVE), so no socket owns the whole index.
+ * index_text places the text of an index the same way, as binary search
+ * reads it on every step. */
+
+#ifndef INDEX_ALLOCATOR
+#define INDEX_ALLOCATOR
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+enum class page_policy { standard, transparent_huge, explicit_huge };
+enum class numa_policy { local, interleave };
+
+struct memory_policy {
+    page_policy pages = page_policy::standard;
+    numa_policy numa = numa_policy::local;
+
+    bool operator==(const memory_policy &) const = default;
+};
+
+inline std::string policy_name(const memory_policy &policy)
+{
+    std::string name = policy.pages == page_policy::standard         ? "4k"
+                       : policy.pages == page_policy::transparent_huge ? "thp"
+                                                                       : "hugetlb";
+    return name + (policy.numa == numa_policy::interleave ? "_interleave" : "_local");
+}
+
+// Bit mask of online NUMA nodes, from a list such as "0-1,3"
+inline unsigned long online_numa_nodes()
+{
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string list;
+    unsigned long mask = 0;
+    if (!(online >> list))
+        return 1;
+
+    std::size_t pos = 0;
+    while (pos < list.size()) {
+        std::size_t end = list.find(',', pos);
+        if (end == std::string::npos)
+            end = list.size();
+        std::string range = list.substr(pos, end - pos);
+        std::size_t dash = range.find('-');
+        unsigned long lo = std::stoul(range.substr(0, dash));
+        unsigned long hi = dash == std::string::npos ? lo : std::stoul(range.substr(dash + 1));
+        for (unsigned long node = lo; node <= hi && node < 8 * sizeof(mask); node++)
+            mask |= 1UL << node;
+        pos = end + 1;
+    }
+    return mask;
+}
+
+template <class T>
+class index_allocator
+{
+private:
+    static constexpr std::size_t huge_page = std::size_t(1) << 21;
+
+    static std::size_t mapped_bytes(std::size_t n)
+    {
+        return (n * sizeof(T) + huge_page - 1) / huge_page * huge_page;
+    }
+
+    bool uses_mmap() const
+    {
+        return policy != memory_policy{};
+    }
+
+public:
+    using value_type = T;
+    // Assigning or swapping a container hands over its mapping as well, so
+    // an array built with a policy keeps it when moved into place
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    memory_policy policy;
+
+    index_allocator() = default;
+
+    index_allocator(const memory_policy &p) : policy(p)
+    {
+    }
+
+    template <class U>
+    index_allocator(const index_allocator<U> &other) : policy(other.policy)
+    {
+    }
+
+    T *allocate(std::size_t n)
+    {
+        if (!uses_mmap())
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+
+        std::size_t bytes = mapped_bytes(n);
+        void *p = MAP_FAILED;
+        if (policy.pages == page_policy::explicit_huge)
+            p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT), -1, 0);
+        if (p == MAP_FAILED) {
+            p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED)
+                throw std::bad_alloc();
+            if (policy.pages != page_policy::standard)
+                madvise(p, bytes, MADV_HUGEPAGE);
+        }
+
+        // Placement is decided at first touch, which happens after this
+        if (policy.numa == numa_policy::interleave) {
+            unsigned long nodes = online_numa_nodes();
+            syscall(SYS_mbind, p, bytes, MPOL_INTERLEAVE, &nodes, 8 * sizeof(nodes), 0);
+        }
+
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, std::size_t n)
+    {
+        if (!uses_mmap())
+            ::operator delete(p);
+        else
+            munmap(p, mapped_bytes(n));
+    }
+
+    template <class U>
+    bool operator==(const index_allocator<U> &other) const
+    {
+        return policy == other.policy;
+    }
+};
+
+// Text of an index, placed like its arrays. With the default policy the
+// string is kept as given; otherwise it is copied once into mapped storage,
+// so both copies exist until the constructor returns
+class index_text
+{
+private:
+    std::string plain;
+    std::vector<char, index_allocator<char>> placed;
+
+public:
+    index_text() = default;
+
+    index_text(std::string text, const memory_policy &policy) : placed(index_allocator<char>(policy))
+    {
+        if (policy == memory_policy{})
+            plain = std::move(text);
+        else
+            placed.assign(text.begin(), text.end());
+    }
+
+    operator std::string_view() const
+    {
+        return placed.empty() ? std::string_view(plain) : std::string_view(placed.data(), placed.size());
+    }
+};
+
+#endif
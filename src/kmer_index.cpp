@@ -0,0 +1,201 @@
+/** Fixed-length k-mer table over a suffix_array_lcp.
+ *
+ * Every distinct k-mer of the text is one run of SA rows whose LCP with
+ * the previous row is >= k, so a single pass over LCP lists all of them
+ * with their SA interval. They are stored in an open-addressing table
+ * (linear probing, load <= 1/2) keyed by a hash of the k-mer, so
+ * count()/interval() of a k-mer cost one hash of k bytes and usually one
+ * probe, instead of the O(k lg n) binary search of the index.
+ *
+ * Slots keep the k-mer as the text position of one occurrence, so the
+ * table stays 32 bytes per distinct k-mer whatever k is, and lookups
+ * compare against the text. The text must outlive the table; load() takes
+ * it back when reading a serialized table. */
+
+#ifndef KMER_INDEX
+#define KMER_INDEX
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "suffix_array_lcp.cpp"
+
+class kmer_index
+{
+private:
+    struct slot {
+        std::uint64_t hash;
+        std::int64_t position; // Of one occurrence in the text
+        std::int64_t first;    // SA interval [first, first + count)
+        std::int64_t count;    // 0: empty slot
+    };
+
+    static constexpr char magic[8] = {'K', 'M', 'E', 'R', 'I', 'D', 'X', '1'};
+
+    std::string_view t;
+    std::int64_t k = 0;
+    std::int64_t distinct = 0;
+    std::vector<slot> table;
+
+    // FNV-1a, then a murmur3 finalizer to spread the low bits used for the
+    // slot. Fixed, so serialized tables stay valid across builds
+    static std::uint64_t hash(std::string_view kmer)
+    {
+        std::uint64_t h = 0xcbf29ce484222325;
+        for (char c : kmer)
+            h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccd;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53;
+        h ^= h >> 33;
+        return h;
+    }
+
+    const slot *find(std::string_view kmer) const
+    {
+        if (static_cast<std::int64_t>(kmer.length()) != k || table.empty())
+            return nullptr;
+        std::uint64_t h = hash(kmer), mask = table.size() - 1;
+        for (std::uint64_t i = h & mask;; i = (i + 1) & mask) {
+            const slot &s = table[i];
+            if (s.count == 0)
+                return nullptr;
+            if (s.hash == h && t.substr(s.position, k) == kmer)
+                return &s;
+        }
+    }
+
+    void insert(const slot &entry)
+    {
+        std::uint64_t mask = table.size() - 1;
+        std::uint64_t i = entry.hash & mask;
+        while (table[i].count != 0)
+            i = (i + 1) & mask;
+        table[i] = entry;
+    }
+
+    kmer_index() = default;
+
+public:
+    // index must outlive the table, which refers to its text
+    template <class t_lcp>
+    kmer_index(const suffix_array_lcp<t_lcp> &index, std::int64_t k) : t(index.text()), k(k)
+    {
+        if (k <= 0)
+            throw std::invalid_argument("kmer_index: k must be positive");
+
+        // Rows of the SA, ETX included; a run of LCP >= k is one k-mer,
+        // and suffixes shorter than k (they reach the ETX) are skipped
+        std::int64_t n = t.length() + 1;
+        auto for_each_kmer = [&](auto &&visit) {
+            std::int64_t first = 0;
+            for (std::int64_t i = 1; i <= n; i++) {
+                if (i < n && index.lcp(i) >= k)
+                    continue;
+                if (index[first] + k <= n - 1)
+                    visit(first, i);
+                first = i;
+            }
+        };
+
+        for_each_kmer([&](std::int64_t, std::int64_t) { distinct++; });
+        table.assign(std::bit_ceil(static_cast<std::uint64_t>(2 * distinct + 1)), slot{0, 0, 0, 0});
+        for_each_kmer([&](std::int64_t first, std::int64_t last) {
+            std::int64_t position = index[first];
+            insert({hash(t.substr(position, k)), position, first, last - first});
+        });
+    }
+
+    std::int64_t length() const
+    {
+        return k;
+    }
+
+    // Number of distinct k-mers
+    std::int64_t size() const
+    {
+        return distinct;
+    }
+
+    // SA range [first, last) of kmer, {0, 0} if absent or not of length k
+    std::pair<std::int64_t, std::int64_t> interval(std::string_view kmer) const
+    {
+        const slot *s = find(kmer);
+        return s ? std::pair<std::int64_t, std::int64_t>{s->first, s->first + s->count}
+                 : std::pair<std::int64_t, std::int64_t>{0, 0};
+    }
+
+    std::int64_t count(std::string_view kmer) const
+    {
+        const slot *s = find(kmer);
+        return s ? s->count : 0;
+    }
+
+    std::int64_t size_in_bytes() const
+    {
+        return sizeof(slot) * table.size();
+    }
+
+    // Binary layout: magic, k, distinct, slot count, slots. Native byte
+    // order, so tables move only between machines of the same endianness
+    void serialize(std::ostream &out) const
+    {
+        std::int64_t header[3] = {k, distinct, static_cast<std::int64_t>(table.size())};
+        out.write(magic, sizeof(magic));
+        out.write(reinterpret_cast<const char *>(header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(table.data()), sizeof(slot) * table.size());
+        if (!out)
+            throw std::runtime_error("kmer_index: write failed");
+    }
+
+    // text: the text of the index the table was built from
+    static kmer_index load(std::istream &in, std::string_view text)
+    {
+        char read_magic[sizeof(magic)];
+        std::int64_t header[3];
+        in.read(read_magic, sizeof(read_magic));
+        in.read(reinterpret_cast<char *>(header), sizeof(header));
+        if (!in || !std::equal(read_magic, read_magic + sizeof(magic), magic))
+            throw std::runtime_error("kmer_index: not a serialized k-mer table");
+        // Lookups stop at an empty slot, so the load must stay below 1/2
+        if (header[0] <= 0 || header[1] < 0 || header[2] <= 0 ||
+            !std::has_single_bit(static_cast<std::uint64_t>(header[2])) || 2 * header[1] >= header[2])
+            throw std::runtime_error("kmer_index: corrupt header");
+
+        kmer_index result;
+        result.t = text;
+        result.k = header[0];
+        result.distinct = header[1];
+        result.table.resize(header[2]);
+        in.read(reinterpret_cast<char *>(result.table.data()), sizeof(slot) * result.table.size());
+        if (!in)
+            throw std::runtime_error("kmer_index: truncated table");
+        std::int64_t used = 0;
+        for (const slot &s : result.table) {
+            if (s.count == 0)
+                continue;
+            if (s.count < 0 || s.first < 0 || s.position < 0)
+                throw std::runtime_error("kmer_index: corrupt slot");
+            // SA rows include the ETX, hence length + 1; the hash catches a
+            // different text of the same length
+            if (s.position + result.k > static_cast<std::int64_t>(text.length()) ||
+                s.first + s.count > static_cast<std::int64_t>(text.length()) + 1 ||
+                s.hash != hash(text.substr(s.position, result.k)))
+                throw std::runtime_error("kmer_index: table does not match the text");
+            used++;
+        }
+        if (used != result.distinct)
+            throw std::runtime_error("kmer_index: slot count does not match the header");
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,95 @@
+/** LCP array construction from the text and its suffix array.
+ *
+ *  - Kasai: sequential over text positions, through the inverse SA.
+ *  - Phi: same comparisons, but PLCP is computed from Phi[SA[i]] = SA[i-1]
+ *    in independent chunks of text positions. Each chunk restarts h at 0,
+ *    so the extra work is bounded by one LCP value per chunk, and the
+ *    result is identical to Kasai's. */
+
+#ifndef LCP_CONSTRUCTION
+#define LCP_CONSTRUCTION
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "build_trace.cpp"
+#include "construction_arena.cpp"
+#include "parallel.cpp"
+
+inline void build_lcp_kasai(std::string_view t, std::span<const std::int64_t> SA, std::span<std::int64_t> LCP,
+                            construction_arena &arena)
+{
+    arena_scope scope(arena);
+    std::int64_t n = t.length();
+    std::int64_t i, j;
+    auto rank = arena.allocate<std::int64_t>(n);
+    for (i = 0; i < n; i++)
+        rank[SA[i]] = i;
+
+    std::int64_t h = 0;
+    for (i = 0; i < n; i++) {
+        if (rank[i] > 0) {
+            j = SA[rank[i] - 1];
+            while (i + h < n && j + h < n && t[i + h] == t[j + h])
+                h++;
+            LCP[rank[i]] = h;
+            if (h > 0)
+                h--;
+        } else {
+            LCP[rank[i]] = 0;
+        }
+    }
+}
+
+inline void build_lcp_phi(std::string_view t, std::span<const std::int64_t> SA, std::span<std::int64_t> LCP,
+                          std::int64_t threads, construction_arena &arena)
+{
+    arena_scope scope(arena);
+    std::int64_t n = t.length();
+
+    // Phi[SA[i]] = SA[i - 1]; -1 marks the first suffix
+    auto phi = arena.allocate<std::int64_t>(n);
+    parallel_chunks(n, threads, [&](std::int64_t lo, std::int64_t hi) {
+        for (std::int64_t i = lo; i < hi; i++)
+            phi[SA[i]] = i > 0 ? SA[i - 1] : -1;
+    });
+
+    // PLCP over text positions, overwriting Phi in place
+    parallel_chunks(n, threads, [&](std::int64_t lo, std::int64_t hi) {
+        std::int64_t h = 0;
+        for (std::int64_t i = lo; i < hi; i++) {
+            std::int64_t j = phi[i];
+            if (j < 0) {
+                h = 0;
+            } else {
+                while (i + h < n && j + h < n && t[i + h] == t[j + h])
+                    h++;
+            }
+            phi[i] = h;
+            if (h > 0)
+                h--;
+        }
+    });
+
+    parallel_chunks(n, threads, [&](std::int64_t lo, std::int64_t hi) {
+        for (std::int64_t i = lo; i < hi; i++)
+            LCP[i] = phi[SA[i]];
+    });
+}
+
+// Temporaries come from arena when given, otherwise from a local one
+inline void build_lcp(std::string_view t, std::span<const std::int64_t> SA, std::span<std::int64_t> LCP,
+                      std::int64_t threads, construction_arena *arena = nullptr)
+{
+    construction_arena local;
+    construction_arena &scratch = arena ? *arena : local;
+    trace_scope phase("lcp", {{"threads", threads}});
+
+    if (threads > 1)
+        build_lcp_phi(t, SA, LCP, threads, scratch);
+    else
+        build_lcp_kasai(t, SA, LCP, scratch);
+}
+
+#endif
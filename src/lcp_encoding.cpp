@@ -0,0 +1,296 @@
+/** LCP array encodings for suffix_array_lcp.
+ *
+ * All encodings are built from the plain LCP array and the SA and expose
+ * the same read-only accessor, lcp[i]:
+ *  - lcp_vector: plain 64-bit integers (8n bytes),
+ *  - lcp_byte: one byte per entry plus a sorted table for values >= 255,
+ *  - lcp_plcp: Sadakane's 2n-bit PLCP, answered through SA (needs select),
+ *  - lcp_dac: direct access codes with 8-bit chunks (needs rank).
+ *
+ * build() takes the memory_policy of the index, and every array an
+ * encoding keeps, rank/select directories included, is allocated with it
+ * (see index_allocator.cpp). Scratch used only while building is not. */
+
+#ifndef LCP_ENCODING
+#define LCP_ENCODING
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "index_allocator.cpp"
+
+template <class T>
+using lcp_array = std::vector<T, index_allocator<T>>;
+
+// Bit vector with rank and select support
+// Rank: cumulative counts every 512 bits, then popcount inside the block
+// Select: word of every 512th one, then scan words forward
+class lcp_bits
+{
+private:
+    static constexpr std::int64_t block_words = 8;
+    static constexpr std::int64_t select_sample = 512;
+
+    lcp_array<std::uint64_t> words;
+    lcp_array<std::uint64_t> blocks;  // Ones before each block
+    lcp_array<std::uint64_t> samples; // Word holding each sampled one
+    std::int64_t length = 0;
+
+public:
+    void resize(std::int64_t n, const memory_policy &policy = {})
+    {
+        index_allocator<std::uint64_t> allocator(policy);
+        length = n;
+        words = lcp_array<std::uint64_t>((n + 63) / 64, 0, allocator);
+        blocks = lcp_array<std::uint64_t>(allocator);
+        samples = lcp_array<std::uint64_t>(allocator);
+    }
+
+    void set(std::int64_t i)
+    {
+        words[i / 64] |= std::uint64_t(1) << (i % 64);
+    }
+
+    bool operator[](std::int64_t i) const
+    {
+        return (words[i / 64] >> (i % 64)) & 1;
+    }
+
+    // Must be called after the last set() and before rank1/select1
+    void init_support()
+    {
+        std::int64_t w, ones = 0;
+        blocks.clear();
+        samples.clear();
+        for (w = 0; w < static_cast<std::int64_t>(words.size()); w++) {
+            if (w % block_words == 0)
+                blocks.push_back(ones);
+            std::int64_t pc = std::popcount(words[w]);
+            // Record the word where each multiple of select_sample falls
+            while (static_cast<std::int64_t>(samples.size()) * select_sample < ones + pc)
+                samples.push_back(w);
+            ones += pc;
+        }
+    }
+
+    // Ones in [0, i)
+    std::int64_t rank1(std::int64_t i) const
+    {
+        std::int64_t w = i / 64;
+        std::int64_t ones = blocks[w / block_words];
+        for (std::int64_t b = w - w % block_words; b < w; b++)
+            ones += std::popcount(words[b]);
+        if (i % 64)
+            ones += std::popcount(words[w] & ((std::uint64_t(1) << (i % 64)) - 1));
+        return ones;
+    }
+
+    // Position of the k-th one, k starting at 0
+    std::int64_t select1(std::int64_t k) const
+    {
+        std::int64_t w = samples[k / select_sample];
+        std::int64_t remaining = k - rank1(w * 64);
+        std::int64_t pc;
+        while ((pc = std::popcount(words[w])) <= remaining) {
+            remaining -= pc;
+            w++;
+        }
+        std::uint64_t x = words[w];
+        for (; remaining > 0; remaining--)
+            x &= x - 1;
+        return w * 64 + std::countr_zero(x);
+    }
+
+    std::int64_t size() const
+    {
+        return length;
+    }
+
+    std::int64_t memory_usage() const
+    {
+        return sizeof(std::uint64_t) * (words.size() + blocks.size() + samples.size());
+    }
+};
+
+class lcp_vector
+{
+private:
+    lcp_array<std::int64_t> lcp;
+
+public:
+    void build(std::span<const std::int64_t> LCP, std::span<const std::int64_t>, const memory_policy &policy = {})
+    {
+        lcp = lcp_array<std::int64_t>(LCP.begin(), LCP.end(), index_allocator<std::int64_t>(policy));
+    }
+
+    std::int64_t operator[](std::int64_t i) const
+    {
+        return lcp[i];
+    }
+
+    std::int64_t size() const
+    {
+        return lcp.size();
+    }
+
+    std::int64_t memory_usage() const
+    {
+        return sizeof(std::int64_t) * lcp.size();
+    }
+};
+
+class lcp_byte
+{
+private:
+    static constexpr std::int64_t escape = 255;
+
+    lcp_array<std::uint8_t> small;
+    lcp_array<std::pair<std::int64_t, std::int64_t>> overflow; // (index, value) sorted by index
+
+public:
+    void build(std::span<const std::int64_t> LCP, std::span<const std::int64_t>, const memory_policy &policy = {})
+    {
+        small = lcp_array<std::uint8_t>(LCP.size(), index_allocator<std::uint8_t>(policy));
+        overflow = decltype(overflow)(index_allocator<std::pair<std::int64_t, std::int64_t>>(policy));
+        for (std::int64_t i = 0; i < static_cast<std::int64_t>(LCP.size()); i++) {
+            if (LCP[i] < escape) {
+                small[i] = LCP[i];
+            } else {
+                small[i] = escape;
+                overflow.emplace_back(i, LCP[i]);
+            }
+        }
+    }
+
+    std::int64_t operator[](std::int64_t i) const
+    {
+        if (small[i] < escape)
+            return small[i];
+        auto it = std::lower_bound(overflow.begin(), overflow.end(), std::make_pair(i, std::int64_t(0)));
+        return it->second;
+    }
+
+    std::int64_t size() const
+    {
+        return small.size();
+    }
+
+    std::int64_t memory_usage() const
+    {
+        return sizeof(std::uint8_t) * small.size() +
+               sizeof(std::pair<std::int64_t, std::int64_t>) * overflow.size();
+    }
+};
+
+// PLCP[j] + j never decreases along the text, so PLCP[j] is stored as a one
+// at position PLCP[j] + 2j of a 2n-bit vector and LCP[i] = PLCP[SA[i]].
+// Keeps a view of the SA, which must outlive this object.
+class lcp_plcp
+{
+private:
+    lcp_bits h;
+    std::span<const std::int64_t> SA;
+
+public:
+    void build(std::span<const std::int64_t> LCP, std::span<const std::int64_t> sa, const memory_policy &policy = {})
+    {
+        std::int64_t n = LCP.size();
+        SA = sa;
+
+        std::vector<std::int64_t> plcp(n);
+        for (std::int64_t i = 0; i < n; i++)
+            plcp[SA[i]] = LCP[i];
+
+        h.resize(2 * n + 1, policy);
+        for (std::int64_t j = 0; j < n; j++) {
+            if (j > 0 && plcp[j] + 1 < plcp[j - 1])
+                throw std::invalid_argument("lcp_plcp: PLCP[j] + j is not monotone");
+            h.set(plcp[j] + 2 * j);
+        }
+        h.init_support();
+    }
+
+    std::int64_t operator[](std::int64_t i) const
+    {
+        std::int64_t j = SA[i];
+        return h.select1(j) - 2 * j;
+    }
+
+    std::int64_t size() const
+    {
+        return SA.size();
+    }
+
+    std::int64_t memory_usage() const
+    {
+        return h.memory_usage();
+    }
+};
+
+// Values are split in 8-bit chunks; level l keeps the l-th chunk of every
+// value that needs it, and a bit telling whether the value continues.
+// The position at the next level is the rank of that bit.
+class lcp_dac
+{
+private:
+    std::vector<lcp_array<std::uint8_t>> chunks;
+    std::vector<lcp_bits> more;
+
+public:
+    void build(std::span<const std::int64_t> LCP, std::span<const std::int64_t>, const memory_policy &policy = {})
+    {
+        std::vector<std::uint64_t> values(LCP.begin(), LCP.end());
+        std::vector<std::uint64_t> next;
+        chunks.clear();
+        more.clear();
+
+        while (!values.empty()) {
+            std::int64_t m = values.size();
+            chunks.emplace_back(m, index_allocator<std::uint8_t>(policy));
+            more.emplace_back();
+            more.back().resize(m, policy);
+            next.clear();
+            for (std::int64_t i = 0; i < m; i++) {
+                chunks.back()[i] = values[i] & 0xFF;
+                if (values[i] >> 8) {
+                    more.back().set(i);
+                    next.push_back(values[i] >> 8);
+                }
+            }
+            more.back().init_support();
+            std::swap(values, next);
+        }
+    }
+
+    std::int64_t operator[](std::int64_t i) const
+    {
+        std::uint64_t value = chunks[0][i];
+        std::int64_t l = 0;
+        while (more[l][i]) {
+            i = more[l].rank1(i);
+            l++;
+            value |= std::uint64_t(chunks[l][i]) << (8 * l);
+        }
+        return value;
+    }
+
+    std::int64_t size() const
+    {
+        return chunks.empty() ? 0 : chunks[0].size();
+    }
+
+    std::int64_t memory_usage() const
+    {
+        std::int64_t total_memory = 0;
+        for (std::size_t l = 0; l < chunks.size(); l++)
+            total_memory += sizeof(std::uint8_t) * chunks[l].size() + more[l].memory_usage();
+        return total_memory;
+    }
+};
+
+#endif
@@ -0,0 +1,182 @@
+/** Heap and RSS tracking for the benchmark harnesses.
+ *
+ * Replaces the global operator new/delete with versions that count live
+ * bytes, their high-water mark and the number of allocations. The
+ * replacement must be linked once, so include this file from exactly one
+ * translation unit (the uhr harness). Memory taken with malloc directly,
+ * as sdsl does, only shows up in the RSS figures.
+ *
+ * memory_phase measures one phase: heap peak above the level at its start,
+ * allocations made during it, and the process RSS high-water mark, which
+ * is reset at the start of the phase when the kernel allows it. */
+
+#ifndef MEMORY_TRACKER
+#define MEMORY_TRACKER
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <sys/resource.h>
+
+namespace memory_tracker {
+
+inline std::atomic<std::int64_t> current_bytes{0};
+inline std::atomic<std::int64_t> peak_bytes{0};
+inline std::atomic<std::int64_t> allocations{0};
+
+// Room in front of each block for its size, keeping malloc's alignment
+constexpr std::size_t header = 16;
+
+inline void *allocate(std::size_t size)
+{
+    void *block = std::malloc(size + header);
+    if (!block)
+        return nullptr;
+    *static_cast<std::size_t *>(block) = size;
+
+    std::int64_t now = current_bytes += size;
+    std::int64_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (now > peak && !peak_bytes.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+        ;
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    return static_cast<char *>(block) + header;
+}
+
+// Kept out of line: once inlined into operator delete, GCC 12 follows a
+// new-expression into this free() and reports -Wmismatched-new-delete and
+// -Warray-bounds on the header read, although the block is ours
+[[gnu::noinline]] inline void release(void *p)
+{
+    if (!p)
+        return;
+    void *block = static_cast<char *>(p) - header;
+    current_bytes -= *static_cast<std::size_t *>(block);
+    std::free(block);
+}
+
+// Reads a "Key:   123 kB" line from /proc/self/status, in bytes
+inline std::int64_t proc_status_bytes(const std::string &key)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.compare(0, key.length() + 1, key + ":") == 0)
+            return std::stoll(line.substr(key.length() + 1)) * 1024;
+    return -1;
+}
+
+inline std::int64_t current_rss()
+{
+    return proc_status_bytes("VmRSS");
+}
+
+// RSS high-water mark; falls back to getrusage without /proc
+inline std::int64_t peak_rss()
+{
+    std::int64_t hwm = proc_status_bytes("VmHWM");
+    if (hwm >= 0)
+        return hwm;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss * 1024;
+}
+
+// Resets VmHWM to the current RSS; false if not permitted
+inline bool reset_peak_rss()
+{
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    return static_cast<bool>(clear_refs);
+}
+
+} // namespace memory_tracker
+
+struct phase_memory {
+    std::int64_t peak_heap;   // Bytes above the heap level at phase start
+    std::int64_t allocations; // Calls to operator new during the phase
+    std::int64_t peak_rss;    // Process RSS high-water mark
+};
+
+class memory_phase
+{
+private:
+    std::int64_t base_bytes;
+    std::int64_t base_allocations;
+
+public:
+    // Phases must not be nested: each one resets the shared peaks
+    memory_phase()
+    {
+        memory_tracker::reset_peak_rss();
+        base_bytes = memory_tracker::current_bytes;
+        base_allocations = memory_tracker::allocations;
+        memory_tracker::peak_bytes = base_bytes;
+    }
+
+    phase_memory finish() const
+    {
+        return {memory_tracker::peak_bytes - base_bytes,
+                memory_tracker::allocations - base_allocations,
+                memory_tracker::peak_rss()};
+    }
+};
+
+void *operator new(std::size_t size)
+{
+    void *p = memory_tracker::allocate(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return memory_tracker::allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return memory_tracker::allocate(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    memory_tracker::release(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    memory_tracker::release(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    memory_tracker::release(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    memory_tracker::release(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    memory_tracker::release(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    memory_tracker::release(p);
+}
+
+#endif
@@ -0,0 +1,35 @@
+/** Minimal fork-join helper for the construction code. */
+
+#ifndef PARALLEL
+#define PARALLEL
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+inline std::int64_t default_threads()
+{
+    return std::max<std::int64_t>(1, std::thread::hardware_concurrency());
+}
+
+// Splits [0, n) into one contiguous chunk per thread and runs fn(lo, hi)
+// on each; the calling thread takes the first chunk
+template <class Fn>
+void parallel_chunks(std::int64_t n, std::int64_t threads, Fn &&fn)
+{
+    threads = std::clamp<std::int64_t>(threads, 1, std::max<std::int64_t>(n, 1));
+    std::int64_t chunk = (n + threads - 1) / threads;
+
+    std::vector<std::thread> workers;
+    for (std::int64_t c = 1; c < threads; c++) {
+        std::int64_t lo = c * chunk, hi = std::min(n, lo + chunk);
+        if (lo < hi)
+            workers.emplace_back([&fn, lo, hi] { fn(lo, hi); });
+    }
+    fn(0, std::min(n, chunk));
+    for (auto &w : workers)
+        w.join();
+}
+
+#endif
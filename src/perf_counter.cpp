@@ -0,0 +1,74 @@
+/** Hardware event counter for the calling thread, via perf_event_open.
+ *
+ * When the kernel refuses the event (perf_event_paranoid, containers,
+ * VMs without a PMU) the counter is invalid and stop() returns -1. */
+
+#ifndef PERF_COUNTER
+#define PERF_COUNTER
+
+#include <cstdint>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+class perf_counter
+{
+private:
+    int fd = -1;
+
+public:
+    perf_counter(std::uint32_t type, std::uint64_t config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = type;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    perf_counter(const perf_counter &) = delete;
+    perf_counter &operator=(const perf_counter &) = delete;
+
+    ~perf_counter()
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+
+    bool valid() const
+    {
+        return fd >= 0;
+    }
+
+    void start()
+    {
+        if (fd < 0)
+            return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    std::int64_t stop()
+    {
+        if (fd < 0)
+            return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        std::int64_t value = 0;
+        if (read(fd, &value, sizeof(value)) != sizeof(value))
+            return -1;
+        return value;
+    }
+};
+
+// Data TLB misses on loads
+constexpr std::uint64_t dtlb_load_misses = PERF_COUNT_HW_CACHE_DTLB |
+                                           (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+#endif
@@ -0,0 +1,187 @@
+/** Concurrent cache of SA intervals in front of an index.
+ *
+ * Keys are patterns, values are the SA range [first, last) returned by the
+ * index's interval(), so a hit answers count() and, for indexes exposing
+ * their SA, locate(). Entries live in shards picked by pattern hash, each
+ * with its own lock and CLOCK eviction.
+ *
+ * On a miss, if the index can search inside a known range, the longest
+ * cached prefix among lengths |p|/2, |p|/4, ... narrows the search. The
+ * |p|/2 prefix is then searched and cached on the way to p, so later
+ * patterns sharing it, or extending it, start from its range. */
+
+#ifndef QUERY_CACHE
+#define QUERY_CACHE
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+template <class Index>
+class query_cache
+{
+private:
+    struct slot {
+        std::string pattern;
+        std::int64_t first = 0, last = 0;
+        bool referenced = false;
+        bool occupied = false;
+    };
+
+    struct shard {
+        std::mutex lock;
+        std::vector<slot> slots;
+        std::unordered_map<std::string, std::size_t> where;
+        std::size_t hand = 0;
+    };
+
+    Index &index;
+    std::vector<shard> shards;
+    std::atomic<std::int64_t> hits{0}, misses{0}, prefix_hits{0};
+
+    // Shortest prefix worth probing on a miss
+    static constexpr std::size_t min_prefix = 4;
+
+    shard &shard_of(std::string_view pattern)
+    {
+        return shards[std::hash<std::string_view>{}(pattern) % shards.size()];
+    }
+
+    bool lookup(std::string_view pattern, std::pair<std::int64_t, std::int64_t> &range)
+    {
+        shard &s = shard_of(pattern);
+        std::lock_guard<std::mutex> guard(s.lock);
+        auto it = s.where.find(std::string(pattern));
+        if (it == s.where.end())
+            return false;
+        slot &e = s.slots[it->second];
+        e.referenced = true;
+        range = {e.first, e.last};
+        return true;
+    }
+
+    void insert(const std::string &pattern, std::pair<std::int64_t, std::int64_t> range)
+    {
+        shard &s = shard_of(pattern);
+        std::lock_guard<std::mutex> guard(s.lock);
+        if (s.where.count(pattern))
+            return;
+
+        // CLOCK: give referenced entries a second chance
+        while (s.slots[s.hand].occupied && s.slots[s.hand].referenced) {
+            s.slots[s.hand].referenced = false;
+            s.hand = (s.hand + 1) % s.slots.size();
+        }
+
+        slot &e = s.slots[s.hand];
+        if (e.occupied)
+            s.where.erase(e.pattern);
+        e.pattern = pattern;
+        e.first = range.first;
+        e.last = range.second;
+        e.referenced = false;
+        e.occupied = true;
+        s.where[pattern] = s.hand;
+        s.hand = (s.hand + 1) % s.slots.size();
+    }
+
+public:
+    query_cache(Index &idx, std::size_t capacity, std::size_t shard_count = 16)
+        : index(idx), shards(shard_count)
+    {
+        std::size_t per_shard = std::max<std::size_t>(1, capacity / shard_count);
+        for (auto &s : shards) {
+            s.slots.resize(per_shard);
+            s.where.reserve(per_shard);
+        }
+    }
+
+    std::pair<std::int64_t, std::int64_t> interval(const std::string &pattern)
+    {
+        std::pair<std::int64_t, std::int64_t> range;
+        if (lookup(pattern, range)) {
+            hits++;
+            return range;
+        }
+        misses++;
+
+        if constexpr (requires { index.interval(pattern, std::int64_t(0), std::int64_t(0)); }) {
+            std::size_t half = pattern.length() / 2, length = half;
+            bool narrowed = false;
+            for (; length >= min_prefix; length /= 2) {
+                if (lookup(std::string_view(pattern).substr(0, length), range)) {
+                    prefix_hits++;
+                    narrowed = true;
+                    break;
+                }
+            }
+            // Without this, prefixes would only hit when some query was
+            // exactly that prefix
+            if (half >= min_prefix && length != half) {
+                std::string head = pattern.substr(0, half);
+                range = narrowed ? index.interval(head, range.first, range.second) : index.interval(head);
+                insert(head, range);
+                narrowed = true;
+            }
+            if (narrowed)
+                range = index.interval(pattern, range.first, range.second);
+            else
+                range = index.interval(pattern);
+        } else {
+            auto [first, last] = index.interval(pattern);
+            range = {first, last};
+        }
+
+        insert(pattern, range);
+        return range;
+    }
+
+    std::int64_t count(const std::string &pattern)
+    {
+        auto [first, last] = interval(pattern);
+        return last - first;
+    }
+
+    // Text positions of the occurrences, for indexes exposing their SA
+    std::vector<std::int64_t> locate(const std::string &pattern)
+        requires requires(Index &i) { i[std::int64_t(0)]; }
+    {
+        auto [first, last] = interval(pattern);
+        std::vector<std::int64_t> positions;
+        positions.reserve(last - first);
+        for (std::int64_t i = first; i < last; i++)
+            positions.push_back(index[i]);
+        return positions;
+    }
+
+    double hit_rate() const
+    {
+        std::int64_t total = hits + misses;
+        return total == 0 ? 0.0 : double(hits) / total;
+    }
+
+    std::int64_t hit_count() const
+    {
+        return hits;
+    }
+
+    std::int64_t miss_count() const
+    {
+        return misses;
+    }
+
+    // Misses that were narrowed down by a cached prefix
+    std::int64_t prefix_hit_count() const
+    {
+        return prefix_hits;
+    }
+};
+
+#endif
@@ -0,0 +1,365 @@
+/** Suffix array construction backends shared by the SA classes.
+ *
+ * The doubling backends sort the cyclic rotations of t, which is the suffix
+ * order since t ends with a unique minimal ETX:
+ *  - doubling: prefix doubling with counting sort on all of t every round,
+ *    stopping as soon as all ranks are distinct, so O(n lg L) for a
+ *    longest repeat of length L, and swapping the rank buffers,
+ *  - original_doubling: the same sort as first written, with all lg n
+ *    rounds and the ranks copied back every round, kept as the baseline
+ *    the other backends are measured against,
+ *  - packed_doubling: prefix doubling that keeps sorting only unresolved
+ *    groups (Larsson-Sadakane style), packing (rank, position) into one
+ *    64-bit key so each group is sorted and re-ranked in a single pass;
+ *    groups are independent, so rounds run in parallel,
+ *  - divsufsort: libdivsufsort, 32-bit for texts under 2^31 characters and
+ *    divsufsort64 above. It sorts plain suffixes, which matches the other
+ *    backends as long as no byte of the text is <= ETX. Only available
+ *    when the headers are found; link with -ldivsufsort -ldivsufsort64.
+ *
+ * construction_stats, when given, counts the doubling rounds executed and
+ * the suffixes (re)sorted over all of them, bucket sort included. */
+
+#ifndef SA_CONSTRUCTION
+#define SA_CONSTRUCTION
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "build_trace.cpp"
+#include "construction_arena.cpp"
+#include "parallel.cpp"
+
+#if __has_include(<divsufsort.h>) && __has_include(<divsufsort64.h>)
+#include <divsufsort.h>
+#include <divsufsort64.h>
+#define SA_HAS_DIVSUFSORT 1
+#else
+#define SA_HAS_DIVSUFSORT 0
+#endif
+
+enum class sa_construction { doubling, packed_doubling, divsufsort, original_doubling };
+
+struct construction_stats {
+    std::int64_t rounds = 0;
+    std::int64_t elements_touched = 0;
+};
+
+// original: run as first written, see original_doubling
+inline void build_sa_doubling(std::string_view t, std::span<std::int64_t> SA, construction_arena &arena,
+                              construction_stats *stats = nullptr, bool original = false)
+{
+    arena_scope scope(arena);
+    std::int64_t n, sigma, one, i, j, k;
+    n = t.length();
+    sigma = 256; // Size of alphabet, ASCII for now
+                 // If changed, must implement key function that maps
+                 // symbols to integers in range 0..sigma uniquely
+    one = 1;
+
+    auto count = arena.allocate<std::int64_t>(std::max(sigma, n));
+    auto p = arena.allocate<std::int64_t>(n); // For shifted indices
+    auto q = arena.allocate<std::int64_t>(n); // Helper for rank
+    auto r = arena.allocate<std::int64_t>(n); // For ranks
+
+    // Only count needs zeroes, the others are written before being read
+    std::fill(count.begin(), count.end(), 0);
+
+    {
+        trace_scope phase("bucket_sort");
+
+        // Counting sort substrings of length 1
+        for (i = 0; i < n; i++)
+            count[static_cast<unsigned char>(t[i])]++;
+        for (i = 1; i < sigma; i++)
+            count[i] += count[i - 1];
+        for (i = n - 1; i >= 0; i--)
+            SA[--count[static_cast<unsigned char>(t[i])]] = i;
+
+        // Set up ranks by comparing pairs and increasing by one if different
+        r[SA[0]] = 0;
+        j = 0;
+        for (i = 1; i < n; i++) {
+            if (t[SA[i - 1]] != t[SA[i]])
+                j++;
+            r[SA[i]] = j;
+        }
+    }
+    if (stats)
+        stats->elements_touched += n;
+
+    // Once ranks are distinct, SA is final: later rounds would not move it
+    for (k = 0; (one << k) < n && (original || j < n - 1); k++) {
+        trace_scope round_trace("doubling_round", {{"h", one << k}});
+
+        // Find cyclic shifted index
+        for (i = 0; i < n; i++) {
+            p[i] = SA[i] - (one << k);
+            if (p[i] < 0)
+                p[i] += n;
+        }
+
+        // Sort again using radix sort
+        // This is just a counting sort, but works as a faster
+        // radix sort because of the shifting hack
+        // We sort first with second half and then first half,
+        // but only once, so it is faster
+        for (i = 0; i <= j; i++)
+            count[i] = 0;
+        for (i = 0; i < n; i++)
+            count[r[p[i]]]++;
+        for (i = 1; i <= j; i++)
+            count[i] += count[i - 1];
+        for (i = n - 1; i >= 0; i--)
+            SA[--count[r[p[i]]]] = p[i];
+
+        // Recompute ranks
+        q[SA[0]] = 0;
+        j = 0;
+        for (i = 1; i < n; i++) {
+            // Check if first half or second half differ
+            if (r[SA[i - 1]] != r[SA[i]] ||
+                r[(SA[i - 1] + (one << k)) % n] != r[(SA[i] + (one << k)) % n])
+                j++;
+
+            q[SA[i]] = j;
+        }
+
+        if (original)
+            std::copy(q.begin(), q.end(), r.begin());
+        else
+            std::swap(r, q);
+
+        if (stats) {
+            stats->rounds++;
+            stats->elements_touched += n;
+        }
+        trace_instant("distinct_ranks", {{"ranks", j + 1}});
+        if (j == n - 1)
+            trace_instant("ranks_unique", {{"round", k}});
+    }
+}
+
+// Stable LSD radix sort of keys by their high 32 bits, two 16-bit digits
+inline void radix_sort_high(std::span<std::uint64_t> keys, std::span<std::uint64_t> buffer)
+{
+    std::vector<std::int64_t> count(1 << 16);
+    std::span<std::uint64_t> from = keys, to = buffer.first(keys.size());
+
+    for (int shift = 32; shift < 64; shift += 16) {
+        std::fill(count.begin(), count.end(), 0);
+        for (std::uint64_t key : from)
+            count[(key >> shift) & 0xFFFF]++;
+        std::int64_t sum = 0;
+        for (auto &c : count)
+            sum += std::exchange(c, sum);
+        for (std::uint64_t key : from)
+            to[count[(key >> shift) & 0xFFFF]++] = key;
+        std::swap(from, to);
+    }
+    // Two passes: the result is back in keys
+}
+
+// threads: groups are split into one run per thread, with about the same
+// number of suffixes each, and every round sorts and re-ranks the runs in
+// parallel. Sorting reads ranks of any position, so the two steps are
+// separated by a join
+inline void build_sa_packed_doubling(std::string_view t, std::span<std::int64_t> SA, construction_arena &arena,
+                                     std::int64_t threads = 1, construction_stats *stats = nullptr)
+{
+    std::int64_t n = t.length();
+    const std::int64_t sigma = 256;
+    const std::uint64_t low = 0xFFFFFFFF;
+
+    // Keys hold (rank, position) in 32 bits each
+    if (n > static_cast<std::int64_t>(low)) {
+        build_sa_doubling(t, SA, arena, stats);
+        return;
+    }
+
+    arena_scope scope(arena);
+
+    // Rank of a rotation is the SA index where its group starts, so ranks of
+    // finished groups are final and subgroups keep their relative order
+    auto rank = arena.allocate<std::uint32_t>(n);
+    auto key = arena.allocate<std::uint64_t>(n);
+    std::vector<std::pair<std::int64_t, std::int64_t>> groups;
+    std::int64_t i, s, e;
+
+    {
+        trace_scope phase("bucket_sort");
+
+        // Counting sort substrings of length 1
+        std::vector<std::int64_t> count(sigma + 1, 0);
+        for (i = 0; i < n; i++)
+            count[static_cast<unsigned char>(t[i]) + 1]++;
+        for (i = 1; i <= sigma; i++)
+            count[i] += count[i - 1];
+        for (i = 0; i < n; i++)
+            rank[i] = count[static_cast<unsigned char>(t[i])];
+        for (i = 0; i < n; i++)
+            SA[count[static_cast<unsigned char>(t[i])]++] = i;
+        for (s = 0; s < n; s = e) {
+            for (e = s + 1; e < n && rank[SA[e]] == s; e++)
+                ;
+            if (e - s > 1)
+                groups.emplace_back(s, e);
+        }
+    }
+    if (stats)
+        stats->elements_touched += n;
+
+    std::int64_t workers = std::max<std::int64_t>(1, threads);
+    std::vector<std::vector<std::pair<std::int64_t, std::int64_t>>> next_groups(workers);
+    std::vector<std::span<std::uint64_t>> buffers(workers);
+    std::vector<std::int64_t> bounds(workers + 1);
+
+    for (std::int64_t h = 1; !groups.empty() && h < n; h *= 2) {
+        // Few suffixes left: not worth starting threads
+        std::int64_t total = 0;
+        for (auto [gs, ge] : groups)
+            total += ge - gs;
+        std::int64_t runs = total < (1 << 16) ? 1 : workers;
+        if (stats) {
+            stats->rounds++;
+            stats->elements_touched += total;
+        }
+        trace_scope round_trace("doubling_round", {{"h", h}, {"unresolved", total}});
+
+        // Groups [bounds[r], bounds[r + 1]) form run r
+        std::int64_t r = 1, seen = 0;
+        bounds[0] = 0;
+        for (std::size_t g = 0; g < groups.size() && r < runs; g++) {
+            seen += groups[g].second - groups[g].first;
+            while (r < runs && seen * runs >= total * r)
+                bounds[r++] = g + 1;
+        }
+        for (; r <= runs; r++)
+            bounds[r] = groups.size();
+
+        // Radix buffers for the large groups, sized for this round
+        arena_scope round(arena);
+        for (r = 0; r < runs; r++) {
+            std::int64_t largest = 0;
+            for (std::int64_t g = bounds[r]; g < bounds[r + 1]; g++)
+                largest = std::max(largest, groups[g].second - groups[g].first);
+            buffers[r] = largest > (1 << 16) ? arena.allocate<std::uint64_t>(largest) : std::span<std::uint64_t>();
+        }
+
+        // Sort every unresolved group by the rank h positions ahead, reading
+        // only ranks from the previous round
+        parallel_chunks(runs, runs, [&](std::int64_t lo, std::int64_t hi) {
+            for (std::int64_t run = lo; run < hi; run++) {
+                for (std::int64_t g = bounds[run]; g < bounds[run + 1]; g++) {
+                    auto [gs, ge] = groups[g];
+                    for (std::int64_t i = gs; i < ge; i++) {
+                        std::int64_t shifted = SA[i] + h;
+                        if (shifted >= n)
+                            shifted -= n;
+                        key[i] = (std::uint64_t(rank[shifted]) << 32) | std::uint64_t(SA[i]);
+                    }
+                    std::span<std::uint64_t> group(key.data() + gs, ge - gs);
+                    if (group.size() > (1 << 16))
+                        radix_sort_high(group, buffers[run]);
+                    else
+                        std::sort(group.begin(), group.end());
+                }
+            }
+        });
+
+        // Write back positions, split groups and re-rank in one pass
+        parallel_chunks(runs, runs, [&](std::int64_t lo, std::int64_t hi) {
+            for (std::int64_t run = lo; run < hi; run++) {
+                next_groups[run].clear();
+                for (std::int64_t g = bounds[run]; g < bounds[run + 1]; g++) {
+                    auto [gs, ge] = groups[g];
+                    std::int64_t s, e;
+                    for (s = gs; s < ge; s = e) {
+                        std::uint64_t half = key[s] >> 32;
+                        for (e = s; e < ge && (key[e] >> 32) == half; e++) {
+                            SA[e] = key[e] & low;
+                            rank[SA[e]] = s;
+                        }
+                        if (e - s > 1)
+                            next_groups[run].emplace_back(s, e);
+                    }
+                }
+            }
+        });
+
+        // Runs are in SA order, so are the new groups
+        groups.clear();
+        for (r = 0; r < runs; r++)
+            groups.insert(groups.end(), next_groups[r].begin(), next_groups[r].end());
+
+        // Every suffix outside a group has a rank of its own
+        if (tracing()) {
+            std::int64_t distinct = n;
+            for (auto [gs, ge] : groups)
+                distinct -= ge - gs - 1;
+            trace_instant("distinct_ranks", {{"ranks", distinct}});
+            if (groups.empty())
+                trace_instant("ranks_unique", {{"h", h}});
+        }
+    }
+}
+
+inline void build_sa_divsufsort(std::string_view t, std::span<std::int64_t> SA, construction_arena &arena)
+{
+#if SA_HAS_DIVSUFSORT
+    arena_scope scope(arena);
+    trace_scope phase("divsufsort");
+    std::int64_t n = t.length();
+    const sauchar_t *text = reinterpret_cast<const sauchar_t *>(t.data());
+
+    if (n < INT32_MAX) {
+        // Half the working memory, then widen into SA
+        auto sa32 = arena.allocate<saidx_t>(n);
+        if (divsufsort(text, sa32.data(), n) != 0)
+            throw std::runtime_error("divsufsort failed");
+        std::copy(sa32.begin(), sa32.end(), SA.begin());
+    } else {
+        static_assert(sizeof(saidx64_t) == sizeof(std::int64_t));
+        if (divsufsort64(text, reinterpret_cast<saidx64_t *>(SA.data()), n) != 0)
+            throw std::runtime_error("divsufsort64 failed");
+    }
+#else
+    (void)t;
+    (void)SA;
+    (void)arena;
+    throw std::runtime_error("build_sa_divsufsort: built without libdivsufsort");
+#endif
+}
+
+// Temporaries come from arena when given, otherwise from a local one
+// threads: only used by packed_doubling
+// stats: counters are added to, not reset; divsufsort leaves them as is
+inline void build_sa(std::string_view t, std::span<std::int64_t> SA, sa_construction method,
+                     construction_arena *arena = nullptr, std::int64_t threads = 1,
+                     construction_stats *stats = nullptr)
+{
+    construction_arena local;
+    construction_arena &scratch = arena ? *arena : local;
+
+    switch (method) {
+    case sa_construction::doubling:
+        build_sa_doubling(t, SA, scratch, stats);
+        break;
+    case sa_construction::packed_doubling:
+        build_sa_packed_doubling(t, SA, scratch, threads, stats);
+        break;
+    case sa_construction::divsufsort:
+        build_sa_divsufsort(t, SA, scratch);
+        break;
+    case sa_construction::original_doubling:
+        build_sa_doubling(t, SA, scratch, stats, true);
+        break;
+    }
+}
+
+#endif
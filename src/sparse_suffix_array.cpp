@@ -0,0 +1,149 @@
+/** Sparse suffix array: only the suffixes starting at multiples of q.
+ *
+ * SA takes 8n/q bytes instead of 8n. An occurrence p of a pattern P with
+ * |P| >= q has exactly one j in [0, q) with p + j sampled, so count() and
+ * locate() search P[j..] for every j and keep the hits whose preceding j
+ * characters match P[0, j). That is q binary searches instead of one, plus
+ * a check of j characters per candidate; for long patterns the binary
+ * searches dominate either way, and they run over n/q entries.
+ *
+ * Patterns shorter than q can start anywhere between two samples, so they
+ * fall back to a scan of the text. q = 1 is the plain suffix array. */
+
+#ifndef SPARSE_SUFFIX_ARRAY
+#define SPARSE_SUFFIX_ARRAY
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "index_allocator.cpp"
+#include "sa_construction.cpp"
+
+class sparse_suffix_array
+{
+private:
+    index_text _t;
+    std::string_view t;
+    std::int64_t q;
+    std::vector<std::int64_t, index_allocator<std::int64_t>> SA; // Sampled suffixes, sorted
+
+    // Calls fn(position) for every occurrence of s, in no particular order
+    template <class Fn>
+    void for_each_occurrence(const std::string_view s, Fn &&fn) const
+    {
+        // Every suffix starts with the empty pattern, as in suffix_array
+        if (s.empty()) {
+            for (std::int64_t p = 0; p < static_cast<std::int64_t>(t.length()); p++)
+                fn(p);
+            return;
+        }
+        if (static_cast<std::int64_t>(s.length()) < q) {
+            for (std::size_t p = t.find(s); p != std::string_view::npos; p = t.find(s, p + 1))
+                fn(static_cast<std::int64_t>(p));
+            return;
+        }
+
+        for (std::int64_t j = 0; j < q; j++) {
+            auto [first, last] = interval(s.substr(j));
+            std::string_view head = s.substr(0, j);
+            for (std::int64_t i = first; i < last; i++) {
+                std::int64_t p = SA[i] - j;
+                if (p >= 0 && t.substr(p, j) == head)
+                    fn(p);
+            }
+        }
+    }
+
+public:
+    // text is taken by value, see suffix_array. The SA is built in full in
+    // the arena and then filtered, so construction still peaks at 8n bytes
+    sparse_suffix_array(std::string text, std::int64_t q, sa_construction method = sa_construction::packed_doubling,
+                        const memory_policy &policy = {}, construction_arena *arena = nullptr)
+        : q(q), SA(index_allocator<std::int64_t>(policy))
+    {
+        if (q <= 0)
+            throw std::invalid_argument("sparse_suffix_array: q must be positive");
+
+        char ETX = 3;
+        text += ETX;
+        _t = index_text(std::move(text), policy);
+        t = _t;
+
+        std::int64_t n = t.length();
+        construction_arena local;
+        construction_arena &scratch = arena ? *arena : local;
+        arena_scope scope(scratch);
+
+        auto full = scratch.allocate<std::int64_t>(n);
+        build_sa(t, full, method, &scratch);
+        SA.reserve((n + q - 1) / q);
+        for (std::int64_t position : full)
+            if (position % q == 0)
+                SA.push_back(position);
+    }
+
+    // Range [first, last) of the sampled suffixes starting with s
+    std::pair<std::int64_t, std::int64_t> interval(const std::string_view s) const
+    {
+        std::int64_t lo = 0, hi = SA.size(), mi, first;
+
+        // Find lower bound
+        while (lo < hi) {
+            mi = lo + (hi - lo) / 2;
+            if (t.substr(SA[mi]) < s)
+                lo = mi + 1;
+            else
+                hi = mi;
+        }
+        first = lo;
+
+        // Find upper bound
+        hi = SA.size();
+        while (lo < hi) {
+            mi = lo + (hi - lo) / 2;
+            if (t.substr(SA[mi]).starts_with(s))
+                lo = mi + 1;
+            else
+                hi = mi;
+        }
+
+        return {first, hi};
+    }
+
+    std::int64_t count(const std::string_view s) const
+    {
+        std::int64_t occurrences = 0;
+        for_each_occurrence(s, [&](std::int64_t) { occurrences++; });
+        return occurrences;
+    }
+
+    std::vector<std::int64_t> locate(const std::string_view s) const
+    {
+        std::vector<std::int64_t> positions;
+        for_each_occurrence(s, [&](std::int64_t p) { positions.push_back(p); });
+        return positions;
+    }
+
+    std::int64_t sampling() const
+    {
+        return q;
+    }
+
+    // Indexed text, without the ETX terminator
+    std::string_view text() const
+    {
+        return t.substr(0, t.length() - 1);
+    }
+
+    std::int64_t size_in_bytes() const
+    {
+        return sizeof(std::int64_t) * SA.size();
+    }
+};
+
+#endif
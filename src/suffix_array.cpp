@@ -8,126 +8,137 @@
 #include <algorithm>
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "async_query.cpp"
+#include "batch_search.cpp"
+#include "index_allocator.cpp"
+#include "sa_construction.cpp"
+
 class suffix_array
 {
 private:
-    std::string _t;
+    index_text _t;
     std::string_view t;
-    std::vector<std::int64_t> SA;
+    std::vector<std::int64_t, index_allocator<std::int64_t>> SA;
 
 public:
-    suffix_array(const std::string &text)
+    // text is taken by value: pass an rvalue, e.g. from text_loader.cpp, to
+    // index it without a copy
+    suffix_array(std::string text, sa_construction method = sa_construction::packed_doubling,
+                 std::int64_t threads = default_threads(), const memory_policy &policy = {},
+                 construction_arena *arena = nullptr)
+        : SA(index_allocator<std::int64_t>(policy))
     {
         // Add lexicographically minimal char at end of text
         // Done to properly compare suffixes
         char ETX = 3;
-        _t = text + ETX;
+        text += ETX;
+        _t = index_text(std::move(text), policy);
         t = _t;
 
-        std::int64_t n, sigma, one, i, j, k;
-        n = t.length();
-        sigma = 256; // Size of alphabet, ASCII for now
-                     // If changed, must implement key function that maps
-                     // symbols to integers in range 0..sigma uniquely
-        one = 1;
-
+        std::int64_t n = t.length();
         SA.resize(n);
-        std::vector<std::int64_t> count(std::max(sigma, n), 0);
-        std::vector<std::int64_t> p(n); // For shifted indices
-        std::vector<std::int64_t> q(n); // Helper for rank
-        std::vector<std::int64_t> r(n); // For ranks
-
-        // Counting sort substrings of length 1
-        for (i = 0; i < n; i++)
-            count[static_cast<unsigned char>(t[i])]++;
-        for (i = 1; i < sigma; i++)
-            count[i] += count[i - 1];
-        for (i = n - 1; i >= 0; i--)
-            SA[--count[static_cast<unsigned char>(t[i])]] = i;
-
-        // Set up ranks by comparing pairs and increasing by one if different
-        r[SA[0]] = 0;
-        j = 0;
-        for (i = 1; i < n; i++) {
-            if (t[SA[i - 1]] != t[SA[i]])
-                j++;
-            r[SA[i]] = j;
+        build_sa(t, SA, method, arena, threads);
+    }
+
+    // SA range [first, last) of the suffixes starting with s
+    // Only looks inside [lo, hi), e.g. the range of a known prefix of s
+    std::pair<std::int64_t, std::int64_t> interval(const std::string_view s, std::int64_t lo, std::int64_t hi) const
+    {
+        if (s.length() > t.length())
+            return {lo, lo};
+
+        std::int64_t mi, first, end;
+        end = hi;
+
+        // Find lower bound
+        while (lo < hi) {
+            mi = lo + (hi - lo) / 2;
+            if (t.substr(SA[mi]) < s)
+                lo = mi + 1;
+            else
+                hi = mi;
         }
+        first = lo;
 
-        for (k = 0; (one << k) < n; k++) {
-            // Find cyclic shifted index
-            for (i = 0; i < n; i++) {
-                p[i] = SA[i] - (one << k);
-                if (p[i] < 0)
-                    p[i] += n;
-            }
-
-            // Sort again using radix sort
-            // This is just a counting sort, but works as a faster
-            // radix sort because of the shifting hack
-            // We sort first with second half and then first half,
-            // but only once, so it is faster
-            for (i = 0; i <= j; i++)
-                count[i] = 0;
-            for (i = 0; i < n; i++)
-                count[r[p[i]]]++;
-            for (i = 1; i <= j; i++)
-                count[i] += count[i - 1];
-            for (i = n - 1; i >= 0; i--)
-                SA[--count[r[p[i]]]] = p[i];
-
-            // Recompute ranks
-            q[SA[0]] = 0;
-            j = 0;
-            for (i = 1; i < n; i++) {
-                // Check if first half or second half differ
-                if (r[SA[i - 1]] != r[SA[i]] ||
-                    r[(SA[i - 1] + (one << k)) % n] != r[(SA[i] + (one << k)) % n])
-                    j++;
-
-                q[SA[i]] = j;
-            }
-
-            for (i = 0; i < n; i++)
-                r[i] = q[i];
+        // Find upper bound
+        // Do not reset lo since it is already at lower bound
+        hi = end;
+        while (lo < hi) {
+            mi = lo + (hi - lo) / 2;
+            if (t.substr(SA[mi]).starts_with(s)) // Suffixes with same prefix are contiguous in SA
+                lo = mi + 1;
+            else
+                hi = mi;
         }
+
+        return {first, hi};
+    }
+
+    std::pair<std::int64_t, std::int64_t> interval(const std::string_view s) const
+    {
+        return interval(s, 0, t.length());
     }
 
-    std::int64_t count(const std::string_view s)
+    std::int64_t count(const std::string_view s) const
+    {
+        auto [first, last] = interval(s);
+        return last - first;
+    }
+
+    // Counts for many patterns at once, overlapping their memory accesses
+    // group: searches kept in flight, see batch_search.cpp
+    template <class Patterns>
+    std::vector<std::int64_t> count_batch(const Patterns &patterns, std::int64_t group = 16) const
+    {
+        std::vector<std::pair<std::int64_t, std::int64_t>> ranges(patterns.size());
+        batch_interval(t, SA, patterns, ranges, group);
+
+        std::vector<std::int64_t> counts(patterns.size());
+        for (std::size_t i = 0; i < ranges.size(); i++)
+            counts[i] = ranges[i].second - ranges[i].first;
+        return counts;
+    }
+
+    // Same search as count, suspending before each SA and text access so a
+    // query_scheduler can run other queries meanwhile, see async_query.cpp
+    // s is taken by value: it must outlive the suspended coroutine
+    query_task<std::int64_t> count_async(std::string s) const
     {
         if (s.length() > t.length())
-            return 0;
+            co_return 0;
 
-        std::int64_t n, lo, mi, hi, matches;
-        n = t.length();
+        std::int64_t lo = 0, hi = t.length(), mi, first, suffix;
 
         // Find lower bound
-        lo = 0;
-        hi = n;
         while (lo < hi) {
             mi = lo + (hi - lo) / 2;
-            if (t.substr(SA[mi]) < s)
+            co_await memory_yield{&SA[mi]};
+            suffix = SA[mi];
+            co_await memory_yield{t.data() + suffix};
+            if (t.substr(suffix) < s)
                 lo = mi + 1;
             else
                 hi = mi;
         }
-        matches = lo;
+        first = lo;
 
         // Find upper bound
-        // Do not set lo = 0 since it is already at lower bound
-        hi = n;
+        hi = t.length();
         while (lo < hi) {
             mi = lo + (hi - lo) / 2;
-            if (t.substr(SA[mi]).starts_with(s)) // Suffixes with same prefix are contiguous in SA
+            co_await memory_yield{&SA[mi]};
+            suffix = SA[mi];
+            co_await memory_yield{t.data() + suffix};
+            if (t.substr(suffix).starts_with(s))
                 lo = mi + 1;
             else
                 hi = mi;
         }
-        matches = hi - matches;
 
-        return matches;
+        co_return hi - first;
     }
 
     std::int64_t& operator[](std::int64_t i)
@@ -135,8 +146,19 @@ public:
         return SA[i];
     }
 
+    std::int64_t operator[](std::int64_t i) const
+    {
+        return SA[i];
+    }
+
+    // Indexed text, without the ETX terminator
+    std::string_view text() const
+    {
+        return t.substr(0, t.length() - 1);
+    }
+
     
-    std::int64_t memory_usage() const
+    std::int64_t size_in_bytes() const
     {
         std::int64_t total_memory = 0;
 
@@ -4,120 +4,103 @@
 #include <algorithm>
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 #include <iostream>
+#include <queue>
+#include <tuple>
 
+#include "lcp_encoding.cpp"
+#include "lcp_construction.cpp"
+#include "index_allocator.cpp"
+#include "sa_construction.cpp"
+
+// t_lcp: LCP encoding, see lcp_encoding.cpp
+template <class t_lcp = lcp_byte>
 class suffix_array_lcp
 {
 private:
-    std::string _t;
+    index_text _t;
     std::string_view t;
-    std::vector<std::int64_t> SA;
-    std::vector<std::int64_t> LCP;
-    std::vector<std::int64_t> rank;
+    std::vector<std::int64_t, index_allocator<std::int64_t>> SA;
+    t_lcp LCP;
+
+    // Bottom-up traversal of the LCP intervals (the internal nodes of the
+    // suffix tree) with a stack, in one pass over LCP. Calls
+    // fn(length, parent_length, first, last, left_maximal) for every
+    // interval [first, last) of length > 0, children before parents.
+    // left_maximal: the occurrences are not all preceded by the same
+    // character, so the repeat cannot be extended to the left
+    template <class Fn>
+    void bottom_up(Fn &&fn) const
+    {
+        // Preceding character of an interval: one byte, none yet, or several
+        const int none = -1, several = 256;
+        auto merge = [&](int a, int b) { return a == none ? b : (b == none || a == b) ? a : several; };
+        auto preceding = [&](std::int64_t i) { return SA[i] == 0 ? several : static_cast<unsigned char>(t[SA[i] - 1]); };
+
+        struct open_interval {
+            std::int64_t length, first;
+            int left;
+        };
+        std::vector<open_interval> stack = {{0, 0, none}};
+        std::int64_t n = t.length();
+
+        for (std::int64_t i = 1; i <= n; i++) {
+            std::int64_t h = i < n ? static_cast<std::int64_t>(LCP[i]) : 0;
+            std::int64_t first = i - 1;
+            int left = preceding(i - 1); // Leaf i - 1, child of the top interval
+            while (h < stack.back().length) {
+                open_interval node = stack.back();
+                stack.pop_back();
+                node.left = merge(node.left, left);
+                fn(node.length, std::max(h, stack.back().length), node.first, i, node.left == several);
+                first = node.first;
+                left = node.left;
+            }
+            if (h > stack.back().length)
+                stack.push_back({h, first, left});
+            else
+                stack.back().left = merge(stack.back().left, left);
+        }
+    }
 
 public:
-    suffix_array_lcp(const std::string &text)
+    // text is taken by value, see suffix_array
+    suffix_array_lcp(std::string text, sa_construction method = sa_construction::packed_doubling,
+                     std::int64_t threads = default_threads(), const memory_policy &policy = {},
+                     construction_arena *arena = nullptr)
+        : SA(index_allocator<std::int64_t>(policy))
     {
         // Add lexicographically minimal char at end of text
         // Done to properly compare suffixes
         char ETX = 3;
-        _t = text + ETX;
+        text += ETX;
+        _t = index_text(std::move(text), policy);
         t = _t;
 
-        std::int64_t n, sigma, one, i, j, k;
-        n = t.length();
-        sigma = 256; // Size of alphabet, ASCII for now
-                     // If changed, must implement key function that maps
-                     // symbols to integers in range 0..sigma uniquely
-        one = 1;
-
+        std::int64_t n = t.length();
         SA.resize(n);
-        std::vector<std::int64_t> count(std::max(sigma, n), 0);
-        std::vector<std::int64_t> p(n); // For shifted indices
-        std::vector<std::int64_t> q(n); // Helper for rank
-        std::vector<std::int64_t> r(n); // For ranks
-
-        // Counting sort substrings of length 1
-        for (i = 0; i < n; i++)
-            count[static_cast<unsigned char>(t[i])]++;
-        for (i = 1; i < sigma; i++)
-            count[i] += count[i - 1];
-        for (i = n - 1; i >= 0; i--)
-            SA[--count[static_cast<unsigned char>(t[i])]] = i;
-
-        // Set up ranks by comparing pairs and increasing by one if different
-        r[SA[0]] = 0;
-        j = 0;
-        for (i = 1; i < n; i++) {
-            if (t[SA[i - 1]] != t[SA[i]])
-                j++;
-            r[SA[i]] = j;
-        }
+        // Scratch for every construction step, including the plain LCP
+        construction_arena local;
+        construction_arena &scratch = arena ? *arena : local;
+        arena_scope scope(scratch);
 
-        for (k = 0; (one << k) < n; k++) {
-            // Find cyclic shifted index
-            for (i = 0; i < n; i++) {
-                p[i] = SA[i] - (one << k);
-                if (p[i] < 0)
-                    p[i] += n;
-            }
-
-            // Sort again using radix sort
-            // This is just a counting sort, but works as a faster
-            // radix sort because of the shifting hack
-            // We sort first with second half and then first half,
-            // but only once, so it is faster
-            for (i = 0; i <= j; i++)
-                count[i] = 0;
-            for (i = 0; i < n; i++)
-                count[r[p[i]]]++;
-            for (i = 1; i <= j; i++)
-                count[i] += count[i - 1];
-            for (i = n - 1; i >= 0; i--)
-                SA[--count[r[p[i]]]] = p[i];
-
-            // Recompute ranks
-            q[SA[0]] = 0;
-            j = 0;
-            for (i = 1; i < n; i++) {
-                // Check if first half or second half differ
-                if (r[SA[i - 1]] != r[SA[i]] ||
-                    r[(SA[i - 1] + (one << k)) % n] != r[(SA[i] + (one << k)) % n])
-                    j++;
-
-                q[SA[i]] = j;
-            }
+        build_sa(t, SA, method, &scratch, threads);
 
-            for (i = 0; i < n; i++)
-                r[i] = q[i];
-        }
+        // LCP construction, Kasai or parallel Phi
+        auto lcp = scratch.allocate<std::int64_t>(n);
+        build_lcp(t, SA, lcp, threads, &scratch);
 
-        // LCP construction using Kasai's algorithm
-        LCP.resize(n);
-        rank.resize(n);
-        for (i = 0; i < n; i++)
-            rank[SA[i]] = i;
-
-        std::int64_t h = 0;
-        for (i = 0; i < n; i++) {
-            if (rank[i] > 0) {
-                j = SA[rank[i] - 1];
-                while (i + h < n && j + h < n && t[i + h] == t[j + h])
-                    h++;
-                LCP[rank[i]] = h;
-                if (h > 0)
-                    h--;
-            } else {
-                LCP[rank[i]] = 0;
-            }
-        }
+        // Encoding keeps a view of SA when it needs one
+        LCP.build(lcp, SA, policy);
     }
 
-    std::int64_t count(const std::string_view s)
+    // SA range [first, last) of the suffixes starting with s
+    std::pair<std::int64_t, std::int64_t> interval(const std::string_view s) const
     {
         if (s.length() > t.length())
-            return 0;
+            return {0, 0};
 
         std::int64_t n = t.length();
         std::int64_t lcp_lo = 0, lcp_hi = 0;
@@ -134,7 +117,7 @@ public:
                 // Found a match - now walk backwards through LCP array
                 // to find the first occurrence where LCP becomes smaller than pattern
                 lcp_lo = mi;
-                while (lcp_lo > 0 && LCP[lcp_lo] >= s.length()) {
+                while (lcp_lo > 0 && LCP[lcp_lo] >= static_cast<std::int64_t>(s.length())) {
                     lcp_lo--;
                 }
                 break;
@@ -161,7 +144,7 @@ public:
                 // Found a match - now walk forward through LCP array
                 // to find the last occurrence where LCP becomes smaller than pattern
                 lcp_hi = mi;
-                while (lcp_hi < n - 1 && LCP[lcp_hi + 1] >= s.length()) {
+                while (lcp_hi < n - 1 && LCP[lcp_hi + 1] >= static_cast<std::int64_t>(s.length())) {
                     lcp_hi++;
                 }
                 break;
@@ -175,7 +158,13 @@ public:
         // If we didn't find any exact match in the second binary search
         std::int64_t last_occurrence = lcp_hi == 0 ? hi : lcp_hi + 1;
         
-        return last_occurrence - first_occurrence;
+        return {first_occurrence, last_occurrence};
+    }
+
+    std::int64_t count(const std::string_view s) const
+    {
+        auto [first, last] = interval(s);
+        return last - first;
     }
 
     std::int64_t& operator[](std::int64_t i)
@@ -183,8 +172,87 @@ public:
         return SA[i];
     }
 
-    
-    std::int64_t memory_usage() const
+    std::int64_t operator[](std::int64_t i) const
+    {
+        return SA[i];
+    }
+
+    std::int64_t lcp(std::int64_t i) const
+    {
+        return LCP[i];
+    }
+
+    // Indexed text, without the ETX terminator
+    std::string_view text() const
+    {
+        return t.substr(0, t.length() - 1);
+    }
+
+    // Longest substring occurring at least twice, as {position, length};
+    // length 0 when no character repeats
+    std::pair<std::int64_t, std::int64_t> longest_repeat() const
+    {
+        std::pair<std::int64_t, std::int64_t> best = {0, 0};
+        for (std::int64_t i = 1; i < static_cast<std::int64_t>(t.length()); i++)
+            if (static_cast<std::int64_t>(LCP[i]) > best.second)
+                best = {SA[i], LCP[i]};
+        return best;
+    }
+
+    // Streams every maximal repeat (not extendable to the left nor to the
+    // right without losing occurrences) of length >= min_length, as
+    // fn(position, length, occurrences)
+    template <class Fn>
+    void maximal_repeats(std::int64_t min_length, Fn &&fn) const
+    {
+        bottom_up([&](std::int64_t length, std::int64_t, std::int64_t first, std::int64_t last, bool left_maximal) {
+            if (length >= min_length && left_maximal)
+                fn(SA[first], length, last - first);
+        });
+    }
+
+    // The k most frequent substrings with length in [min_length,
+    // max_length], as {substring, occurrences}, most frequent first and
+    // longer first among equals. Only repeated substrings are considered.
+    // An interval holds every length in (parent_length, length], all with
+    // the same occurrences, so each is handled in O(1) heap operations
+    std::vector<std::pair<std::string, std::int64_t>> top_substrings(std::int64_t k, std::int64_t min_length,
+                                                                     std::int64_t max_length) const
+    {
+        // Min-heap of (occurrences, length, position) holding the best k
+        using entry = std::tuple<std::int64_t, std::int64_t, std::int64_t>;
+        std::priority_queue<entry, std::vector<entry>, std::greater<entry>> best;
+
+        if (k > 0) {
+            bottom_up([&](std::int64_t length, std::int64_t parent_length, std::int64_t first, std::int64_t last,
+                          bool) {
+                std::int64_t occurrences = last - first;
+                std::int64_t lo = std::max(parent_length + 1, min_length);
+                std::int64_t hi = std::min(length, max_length);
+                // Lengths are taken longest first, and no more than k of them
+                for (std::int64_t m = hi; m >= lo && m > hi - k; m--) {
+                    entry candidate = {occurrences, m, SA[first]};
+                    if (static_cast<std::int64_t>(best.size()) < k)
+                        best.push(candidate);
+                    else if (candidate > best.top()) {
+                        best.pop();
+                        best.push(candidate);
+                    } else
+                        break;
+                }
+            });
+        }
+
+        std::vector<std::pair<std::string, std::int64_t>> result(best.size());
+        for (std::int64_t i = best.size() - 1; i >= 0; i--) {
+            auto [occurrences, length, position] = best.top();
+            best.pop();
+            result[i] = {std::string(t.substr(position, length)), occurrences};
+        }
+        return result;
+    }
+
+    std::int64_t size_in_bytes() const
     {
         std::int64_t total_memory = 0;
 
@@ -192,17 +260,17 @@ public:
         total_memory += sizeof(std::int64_t) * SA.size();
 
         // LCP size
-        total_memory += sizeof(std::int64_t) * LCP.size();
+        total_memory += LCP.memory_usage();
 
 
         return total_memory;
     }
 
-    void print_lcp() {
+    void print_lcp(std::ostream &out = std::cout) const {
         for (std::int64_t i = 0; i < LCP.size(); i++) {
-            std::cout << LCP[i] << " ";
+            out << LCP[i] << " ";
         }
-        std::cout << std::endl;
+        out << std::endl;
     }
     
 };
@@ -1,12 +1,21 @@
 #ifndef SDSL_SUFFIX_ARRAY
 #define SDSL_SUFFIX_ARRAY
 
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <sdsl/suffix_arrays.hpp>
 #include <sdsl/util.hpp>
 
+#include "build_trace.cpp"
+
+// Defaults match sdsl::csa_wt<>; see fmindex for the meaning of the densities
+template <class t_wt = sdsl::wt_huff<>,
+          std::uint32_t t_dens = 32, std::uint32_t t_inv_dens = 64>
 class sdsl_suffix_array {
 private:
-    sdsl::csa_wt<> csa;  // Compressed suffix array
+    sdsl::csa_wt<t_wt, t_dens, t_inv_dens> csa;  // Compressed suffix array
     std::string t;    // Original text
     std::string _t;   // Text with ETX
 public:
@@ -14,20 +23,38 @@ public:
         char ETX = 3;
         _t = text + ETX;
         t = _t;
-        
+
+        trace_scope phase("sdsl_construct");
         sdsl::construct_im(csa, t, 1); // 1 indica construcción en memoria
     }
 
     // Contar ocurrencias de un patrón
-    size_t count(const std::string& pattern) const {
+    std::int64_t count(std::string_view pattern) const {
         return sdsl::count(csa, pattern.begin(), pattern.end());
     }
 
+    // Rango [first, last) del patrón en el arreglo de sufijos
+    std::pair<size_t, size_t> interval(std::string_view pattern) const {
+        size_t sp = 0, ep = 0;
+        size_t occs = sdsl::backward_search(csa, 0, csa.size() - 1, pattern.begin(), pattern.end(), sp, ep);
+        return {sp, sp + occs};
+    }
+
+    // Posiciones de las ocurrencias de un patrón
+    sdsl::int_vector<64> locate(std::string_view pattern) const {
+        return sdsl::locate(csa, pattern.begin(), pattern.end());
+    }
+
+    // Extraer el texto en [begin, end]
+    std::string extract(size_t begin, size_t end) const {
+        return sdsl::extract(csa, begin, end);
+    }
+
     // Obtener el tamaño en bytes de la estructura
-    size_t size_in_bytes() const {
+    std::int64_t size_in_bytes() const {
         return sdsl::size_in_bytes(csa);
     }
 
 };
 
-#endif
\ No newline at end of file
+#endif
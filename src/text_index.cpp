@@ -0,0 +1,20 @@
+/** Interface shared by every index engine.
+ *
+ * Harnesses and query pipelines are templates constrained on TextIndex, so
+ * each engine is called directly (no virtual calls) and a new engine only
+ * has to provide these members to run in all of them. */
+
+#ifndef TEXT_INDEX
+#define TEXT_INDEX
+
+#include <concepts>
+#include <cstdint>
+#include <string_view>
+
+template <class I>
+concept TextIndex = requires(const I &index, std::string_view pattern) {
+    { index.count(pattern) } -> std::convertible_to<std::int64_t>;
+    { index.size_in_bytes() } -> std::convertible_to<std::int64_t>;
+};
+
+#endif
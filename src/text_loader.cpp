@@ -0,0 +1,243 @@
+/** Streaming text ingestion for the indexes.
+ *
+ * Files are read in fixed-size chunks and parsed into one growing string,
+ * reserved up front from the file sizes, so a corpus is held once while
+ * loading. Formats:
+ *  - fasta: '>' header lines are dropped, sequence lines are joined
+ *    without their newlines,
+ *  - fastq: 4-line records, only the sequence line is kept,
+ *  - plain: bytes are kept as they are,
+ *  - detect: fasta if the file starts with '>', fastq with '@', else plain.
+ * Sequence letters are upper-cased (normalize_case), so soft-masked
+ * regions of a genome match their pattern. Every FASTA/FASTQ record and
+ * every plain file starts a new sequence: its offset and name are kept in
+ * loaded_text, and a separator is placed between sequences. By default it
+ * is a newline when either side is a FASTA/FASTQ record, which no
+ * sequence line holds, so no match spans two records; plain files are
+ * joined as they are, and matches may cross from one into the next. */
+
+#ifndef TEXT_LOADER
+#define TEXT_LOADER
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+enum class text_format { detect, plain, fasta, fastq };
+
+struct loaded_text {
+    std::string text;
+    std::vector<std::int64_t> starts; // Offset of each sequence in text
+    std::vector<std::string> names;   // Header, or file name for plain files
+
+    // Sequence holding text position i
+    std::int64_t sequence_of(std::int64_t i) const
+    {
+        return std::upper_bound(starts.begin(), starts.end(), i) - starts.begin() - 1;
+    }
+};
+
+class text_loader
+{
+private:
+    text_format format;
+    bool normalize_case;
+    std::optional<std::string> separator; // Default: see begin_sequence
+    std::size_t chunk_size;
+    loaded_text result;
+
+    // Parser state, carried across chunks
+    text_format current = text_format::plain;
+    bool line_start = true;
+    bool in_header = false;
+    int fastq_line = 0; // Line within a FASTQ record
+    text_format last_format = text_format::plain; // Of the last sequence begun
+    bool file_has_sequence = false; // The current file began a sequence
+
+    void begin_sequence(std::string name)
+    {
+        if (!result.starts.empty()) {
+            if (separator)
+                result.text += *separator;
+            else if (current != text_format::plain || last_format != text_format::plain)
+                result.text += '\n';
+        }
+        last_format = current;
+        result.starts.push_back(result.text.size());
+        result.names.push_back(std::move(name));
+        file_has_sequence = true;
+    }
+
+    char normalize(char c) const
+    {
+        return normalize_case && c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c;
+    }
+
+    void append_sequence(const char *data, std::size_t size)
+    {
+        std::size_t old = result.text.size();
+        result.text.append(data, size);
+        if (normalize_case)
+            for (std::size_t i = old; i < result.text.size(); i++)
+                result.text[i] = normalize(result.text[i]);
+    }
+
+    // End of the line starting at data[i], or size if it continues in the
+    // next chunk
+    static std::size_t line_end(const char *data, std::size_t i, std::size_t size)
+    {
+        const void *newline = std::memchr(data + i, '\n', size - i);
+        return newline ? static_cast<const char *>(newline) - data : size;
+    }
+
+    void parse_fasta(const char *data, std::size_t size)
+    {
+        std::size_t i = 0;
+        while (i < size) {
+            std::size_t end = line_end(data, i, size);
+
+            if (in_header) {
+                result.names.back().append(data + i, end - i);
+                if (end < size) {
+                    if (!result.names.back().empty() && result.names.back().back() == '\r')
+                        result.names.back().pop_back();
+                    in_header = false;
+                    line_start = true;
+                }
+                i = end + 1;
+                continue;
+            }
+
+            if (line_start && data[i] == '>') {
+                begin_sequence("");
+                in_header = true;
+                i++;
+                continue;
+            }
+
+            // Lines before the first header of a file still form a
+            // sequence of their own, not the tail of the previous file's
+            if (!file_has_sequence)
+                begin_sequence("");
+            std::size_t last = end;
+            while (last > i && data[last - 1] == '\r')
+                last--;
+            append_sequence(data + i, last - i);
+            line_start = end < size;
+            i = end + 1;
+        }
+    }
+
+    void parse_fastq(const char *data, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; i++) {
+            char c = data[i];
+            // Every record starts a sequence at its header line, even one
+            // missing its '@'
+            if (fastq_line == 0 && line_start) {
+                begin_sequence("");
+                line_start = false;
+                if (c == '@')
+                    continue;
+            }
+            if (c == '\n') {
+                fastq_line = (fastq_line + 1) % 4;
+                line_start = true;
+                continue;
+            }
+            if (c == '\r')
+                continue;
+
+            if (fastq_line == 0) {
+                result.names.back() += c;
+            } else if (fastq_line == 1) {
+                result.text += normalize(c);
+            }
+            line_start = false;
+        }
+    }
+
+public:
+    text_loader(text_format format = text_format::detect, bool normalize_case = true,
+                std::optional<std::string> separator = std::nullopt, std::size_t chunk_size = std::size_t(1) << 22)
+        : format(format), normalize_case(normalize_case), separator(std::move(separator)),
+          chunk_size(chunk_size)
+    {
+    }
+
+    // Room for files that will be added, avoiding regrowth of the text
+    void reserve(const std::vector<std::string> &filenames)
+    {
+        // The default newline between records takes less room than the
+        // header or FASTQ lines dropped for them
+        std::size_t total = result.text.size() + 1; // The indexes append an ETX
+        for (const auto &filename : filenames)
+            total += std::filesystem::file_size(filename) + (separator ? separator->size() : 1);
+        result.text.reserve(total);
+    }
+
+    void add_file(const std::string &filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file)
+            throw std::runtime_error("Cannot open file: " + filename);
+
+        std::vector<char> chunk(chunk_size);
+        bool first = true;
+        line_start = true;
+        in_header = false;
+        fastq_line = 0;
+        file_has_sequence = false;
+
+        while (file) {
+            file.read(chunk.data(), chunk.size());
+            std::size_t size = file.gcount();
+            if (size == 0)
+                break;
+
+            if (first) {
+                current = format;
+                if (current == text_format::detect)
+                    current = chunk[0] == '>' ? text_format::fasta
+                              : chunk[0] == '@' ? text_format::fastq
+                                                : text_format::plain;
+                if (current == text_format::plain)
+                    begin_sequence(filename);
+                first = false;
+            }
+
+            if (current == text_format::fasta)
+                parse_fasta(chunk.data(), size);
+            else if (current == text_format::fastq)
+                parse_fastq(chunk.data(), size);
+            else
+                result.text.append(chunk.data(), size);
+        }
+    }
+
+    // Hands over the loaded text; the loader is left empty
+    loaded_text take()
+    {
+        return std::move(result);
+    }
+};
+
+// Loads and concatenates filenames, in order
+inline loaded_text load_sequences(const std::vector<std::string> &filenames,
+                                  text_format format = text_format::detect, bool normalize_case = true,
+                                  const std::optional<std::string> &separator = std::nullopt)
+{
+    text_loader loader(format, normalize_case, separator);
+    loader.reserve(filenames);
+    for (const auto &filename : filenames)
+        loader.add_file(filename);
+    return loader.take();
+}
+
+#endif
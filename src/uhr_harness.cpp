@@ -0,0 +1,143 @@
+/** Helpers shared by the uhr benchmark harnesses.
+ *
+ * Every harness takes <filename> first and a test case range
+ * <RUNS> <LOWER> <UPPER> <STEP>; harness_arguments describes the extra
+ * arguments around it, so validate_input prints one consistent usage
+ * message. display_progress draws the progress bar, quartiles summarizes
+ * the timings of a test case, get_random_pattern draws patterns. */
+
+#ifndef UHR_HARNESS
+#define UHR_HARNESS
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Arguments of a harness besides <filename> and the range
+struct harness_arguments {
+    std::vector<std::string> before;   // Between <filename> and <RUNS>, e.g. "<ENGINE>"
+    std::vector<std::string> optional; // After <STEP>, may be omitted, e.g. "<TRACE>"
+    std::vector<std::string> help;     // One usage line per extra argument
+};
+
+inline void validate_input(int argc, char *argv[], std::int64_t& runs,
+    std::int64_t& lower, std::int64_t& upper, std::int64_t& step, const harness_arguments& extra = {})
+{
+    int first = 2 + extra.before.size();
+    if (argc < first + 4 || argc > first + 4 + static_cast<int>(extra.optional.size())) {
+        std::cerr << "Usage: <filename>";
+        for (const auto& argument : extra.before)
+            std::cerr << " " << argument;
+        std::cerr << " <RUNS> <LOWER> <UPPER> <STEP>";
+        for (const auto& argument : extra.optional)
+            std::cerr << " [" << argument << "]";
+        std::cerr << std::endl;
+        std::cerr << "<filename> is the name of the file where performance data will be written." << std::endl;
+        std::cerr << "It is recommended for <filename> to have .csv extension and it should not previously exist." << std::endl;
+        for (const auto& line : extra.help)
+            std::cerr << line << std::endl;
+        std::cerr << "<RUNS>: numbers of runs per test case: should be >= 32." << std::endl;
+        std::cerr << "<LOWER> <UPPER> <STEP>: range of test cases." << std::endl;
+        std::cerr << "These should all be positive." << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Read command line arguments
+    try {
+        runs = std::stoll(argv[first]);
+        lower = std::stoll(argv[first + 1]);
+        upper = std::stoll(argv[first + 2]);
+        step = std::stoll(argv[first + 3]);
+    } catch (std::invalid_argument const& ex) {
+        std::cerr << "std::invalid_argument::what(): " << ex.what() << std::endl;
+        std::exit(EXIT_FAILURE);
+    } catch (std::out_of_range const& ex) {
+        std::cerr << "std::out_of_range::what(): " << ex.what() << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Validate arguments
+    if (runs < 4) {
+        std::cerr << "<RUNS> must be at least 4." << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    if (step <= 0 or lower <= 0 or upper <= 0) {
+        std::cerr << "<STEP>, <LOWER> and <UPPER> have to be positive." << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    if (lower > upper) {
+        std::cerr << "<LOWER> must be at most equal to <UPPER>." << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+inline void display_progress(std::int64_t u, std::int64_t v)
+{
+    const double progress = u / double(v);
+    const std::int64_t width = 70;
+    const std::int64_t p = width * progress;
+    std::int64_t i;
+
+    std::cout << "\033[1m[";
+    for (i = 0; i < width; i++) {
+        if (i < p)
+            std::cout << "=";
+        else if (i == p)
+            std::cout << ">";
+        else
+            std::cout << " ";
+    }
+    std::cout << "] " << std::int64_t(progress * 100.0) << "%\r\033[0m";
+    std::cout.flush();
+}
+
+inline void quartiles(std::vector<double>& data, std::vector<double>& q)
+{
+    q.resize(5);
+    std::size_t n = data.size();
+    std::size_t p;
+
+    std::sort(data.begin(), data.end());
+
+    if (n < 4) {
+        std::cerr << "quartiles needs at least 4 data points." << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Get min and max
+    q[0] = data.front();
+    q[4] = data.back();
+
+    // Find median
+    if (n % 2 == 1) {
+        q[2] = data[n / 2];
+    } else {
+        p = n / 2;
+        q[2] = (data[p - 1] + data[p]) / 2.0;
+    }
+
+    // Find lower and upper quartiles
+    if (n % 4 >= 2) {
+        q[1] = data[n / 4];
+        q[3] = data[(3 * n) / 4];
+    } else {
+        p = n / 4;
+        q[1] = 0.25 * data[p - 1] + 0.75 * data[p];
+        p = (3 * n) / 4;
+        q[3] = 0.75 * data[p - 1] + 0.25 * data[p];
+    }
+}
+
+// Get a random pattern from a text
+inline std::string get_random_pattern(const std::string& text, std::mt19937_64& rng, std::uniform_int_distribution<std::int64_t>& u_distr, std::int64_t pattern_length) {
+    std::int64_t text_length = text.size();
+    std::int64_t start = u_distr(rng) % (text_length - pattern_length);
+    return text.substr(start, pattern_length);
+}
+
+#endif
@@ -0,0 +1,248 @@
+/** Query workloads for the benchmark drivers.
+ *
+ * workload_generator produces an endless pattern stream from the indexed
+ * text: uniform positions, Zipf-distributed hotspots, patterns guaranteed
+ * to be absent (next() throws if none can be found, e.g. length 1 over a
+ * text using every byte), and mutated reads, with lengths drawn from a fixed,
+ * uniform or normal distribution. pattern_file_reader streams one pattern
+ * per line from disk. latency_histogram keeps log2 buckets of latencies. */
+
+#ifndef WORKLOAD
+#define WORKLOAD
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class pattern_source { uniform, zipf, absent, mutated };
+enum class length_distribution { fixed, uniform, normal };
+
+struct workload_config {
+    pattern_source source = pattern_source::uniform;
+    length_distribution lengths = length_distribution::fixed;
+    std::int64_t length = 15;      // Fixed length, or mean for normal
+    std::int64_t min_length = 1;   // Bounds for uniform and normal
+    std::int64_t max_length = 100;
+    double length_stdev = 5.0;
+    std::int64_t hotspots = 1 << 16; // Distinct start positions for zipf
+    double zipf_s = 1.0;
+    double mutation_rate = 0.01;   // Per character, for mutated
+    std::uint64_t seed = 42;
+};
+
+pattern_source parse_pattern_source(const std::string &name)
+{
+    if (name == "uniform")
+        return pattern_source::uniform;
+    if (name == "zipf")
+        return pattern_source::zipf;
+    if (name == "absent")
+        return pattern_source::absent;
+    if (name == "mutated")
+        return pattern_source::mutated;
+    throw std::invalid_argument("Unknown pattern source: " + name);
+}
+
+length_distribution parse_length_distribution(const std::string &name)
+{
+    if (name == "fixed")
+        return length_distribution::fixed;
+    if (name == "uniform")
+        return length_distribution::uniform;
+    if (name == "normal")
+        return length_distribution::normal;
+    throw std::invalid_argument("Unknown length distribution: " + name);
+}
+
+class workload_generator
+{
+private:
+    std::string_view text;
+    workload_config config;
+    std::mt19937_64 rng;
+    std::string alphabet;  // Symbols present in text
+    int missing = -1;      // A byte absent from text, if any
+    static constexpr std::int64_t max_absent_attempts = 1000;
+    std::vector<std::int64_t> hotspots;
+    std::vector<double> zipf_cdf;
+
+    std::int64_t next_length()
+    {
+        std::int64_t m = config.length;
+        if (config.lengths == length_distribution::uniform) {
+            m = std::uniform_int_distribution<std::int64_t>(config.min_length, config.max_length)(rng);
+        } else if (config.lengths == length_distribution::normal) {
+            double x = std::normal_distribution<double>(config.length, config.length_stdev)(rng);
+            m = std::clamp<std::int64_t>(std::llround(x), config.min_length, config.max_length);
+        }
+        return std::clamp<std::int64_t>(m, 1, text.length());
+    }
+
+    std::int64_t random_start(std::int64_t m)
+    {
+        return std::uniform_int_distribution<std::int64_t>(0, text.length() - m)(rng);
+    }
+
+    char random_symbol()
+    {
+        return alphabet[std::uniform_int_distribution<std::size_t>(0, alphabet.size() - 1)(rng)];
+    }
+
+public:
+    workload_generator(std::string_view t, const workload_config &c)
+        : text(t), config(c), rng(c.seed)
+    {
+        if (text.empty())
+            throw std::invalid_argument("workload_generator: empty text");
+
+        std::array<bool, 256> seen{};
+        for (unsigned char ch : text)
+            seen[ch] = true;
+        for (int ch = 0; ch < 256; ch++) {
+            if (seen[ch])
+                alphabet += static_cast<char>(ch);
+            else if (missing < 0 && ch != 3) // ETX terminates the indexed text
+                missing = ch;
+        }
+
+        if (config.source == pattern_source::zipf) {
+            // Hotspot i is requested with probability proportional to 1/(i+1)^s
+            hotspots.resize(config.hotspots);
+            zipf_cdf.resize(config.hotspots);
+            double total = 0;
+            for (std::int64_t i = 0; i < config.hotspots; i++) {
+                hotspots[i] = random_start(1);
+                total += 1.0 / std::pow(i + 1, config.zipf_s);
+                zipf_cdf[i] = total;
+            }
+            for (auto &c : zipf_cdf)
+                c /= total;
+        }
+    }
+
+    std::string next()
+    {
+        std::int64_t m = next_length();
+        std::string pattern;
+
+        switch (config.source) {
+        case pattern_source::uniform:
+            pattern = text.substr(random_start(m), m);
+            break;
+        case pattern_source::zipf: {
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            std::int64_t rank = std::lower_bound(zipf_cdf.begin(), zipf_cdf.end(), u) - zipf_cdf.begin();
+            std::int64_t start = std::min<std::int64_t>(hotspots[std::min<std::int64_t>(rank, hotspots.size() - 1)],
+                                                        text.length() - m);
+            pattern = text.substr(start, m);
+            break;
+        }
+        case pattern_source::absent:
+            // A byte missing from the text guarantees no match
+            pattern = text.substr(random_start(m), m);
+            if (missing >= 0) {
+                pattern[std::uniform_int_distribution<std::int64_t>(0, m - 1)(rng)] = static_cast<char>(missing);
+            } else {
+                // Every byte occurs: resample random strings until one is
+                // not in the text. Each check scans the text, but only
+                // texts using all 255 bytes get here
+                std::int64_t attempts = 0;
+                do {
+                    if (attempts++ == max_absent_attempts)
+                        throw std::runtime_error("workload_generator: no absent pattern of length " +
+                                                 std::to_string(m));
+                    for (auto &ch : pattern)
+                        ch = random_symbol();
+                } while (text.find(pattern) != std::string_view::npos);
+            }
+            break;
+        case pattern_source::mutated: {
+            pattern = text.substr(random_start(m), m);
+            std::bernoulli_distribution mutate(config.mutation_rate);
+            for (auto &ch : pattern)
+                if (mutate(rng))
+                    ch = random_symbol();
+            break;
+        }
+        }
+
+        return pattern;
+    }
+};
+
+class pattern_file_reader
+{
+private:
+    std::ifstream file;
+
+public:
+    pattern_file_reader(const std::string &filename) : file(filename, std::ios::binary)
+    {
+        if (!file)
+            throw std::runtime_error("Cannot open file: " + filename);
+    }
+
+    // One pattern per line; false at end of file
+    bool next(std::string &pattern)
+    {
+        while (std::getline(file, pattern)) {
+            if (!pattern.empty() && pattern.back() == '\r')
+                pattern.pop_back();
+            if (!pattern.empty())
+                return true;
+        }
+        return false;
+    }
+};
+
+// Bucket b holds latencies in [2^(b-1), 2^b) ns, bucket 0 holds < 1 ns
+class latency_histogram
+{
+private:
+    static constexpr int buckets = 64;
+    std::array<std::int64_t, buckets> counts{};
+    std::int64_t total = 0;
+
+public:
+    void add(double ns)
+    {
+        std::uint64_t v = ns < 1 ? 0 : static_cast<std::uint64_t>(ns);
+        counts[std::min<int>(std::bit_width(v), buckets - 1)]++;
+        total++;
+    }
+
+    std::int64_t size() const
+    {
+        return total;
+    }
+
+    // Upper edge of the bucket holding the q-quantile
+    double quantile(double q) const
+    {
+        std::int64_t target = std::ceil(q * total), seen = 0;
+        for (int b = 0; b < buckets; b++) {
+            seen += counts[b];
+            if (seen >= target && seen > 0)
+                return std::ldexp(1.0, b);
+        }
+        return 0;
+    }
+
+    void write_csv(std::ostream &out) const
+    {
+        out << "bucket_lo_ns,bucket_hi_ns,count" << std::endl;
+        for (int b = 0; b < buckets; b++)
+            if (counts[b] > 0)
+                out << (b == 0 ? 0.0 : std::ldexp(1.0, b - 1)) << "," << std::ldexp(1.0, b) << "," << counts[b] << std::endl;
+    }
+};
+
+#endif